@@ -155,6 +155,7 @@ BGVCiphertext operator<<=(BGVCiphertext &ctxt, int r);
 BGVCiphertext BGVRotateEvalAtIndex(BGVCiphertext ctxt, int r);
 boost::python::list BGVHoistedRotations(const BGVCiphertext &ctxt,
                                         const boost::python::list &pylist);
+BGVCiphertext BGVSum(const boost::python::list &pylist);
 BGVCiphertext BGVMultiplySingletonDirect(BGVCiphertext ctxt, int64_t val);
 BGVCiphertext BGVMultiplySingletonIntAndAdd(const BGVCiphertext &ctxt,
                                             int64_t val);
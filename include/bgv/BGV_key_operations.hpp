@@ -65,7 +65,14 @@ public:
 
   void evalPowerOf2RotationKeyGen(const PrivateKey<DCRTPoly> &);
 
+  // levelBudget = {4, 4}, bsgsDim = {0, 0}
   void evalBootstrapSetup();
+  // levelBudget is the number of levels spent on (CoeffsToSlots, SlotsToCoeffs),
+  // bsgsDim their baby-step giant-step dimensions, where 0 lets OpenFHE pick
+  void evalBootstrapSetup(const std::vector<uint32_t> &levelBudget,
+                          const std::vector<uint32_t> &bsgsDim);
+  void evalBootstrapSetupList(const object &levelBudget);
+  void evalBootstrapSetupList2(const object &levelBudget, const object &bsgsDim);
   void evalBootstrapKeyGen(const PrivateKey<DCRTPoly> &);
   list evalBootstrapList(list);
   pyOpenFHE_BGV::BGVCiphertext evalBootstrap(pyOpenFHE_BGV::BGVCiphertext);
@@ -101,10 +108,16 @@ public:
 
 // not entirely sure what the BGV crypto context is like
 // TODO: verify this is the same
-BGVCryptoContext genBGVContext(usint multiplicativeDepth, usint batchSize,
-                               usint plaintextModulus,
-                               SecurityLevel stdLevel = HEStd_128_classic,
-                               usint ringDim = 0);
+// the tuning parameters after ringDim work as for genCKKSContext
+BGVCryptoContext
+genBGVContext(usint multiplicativeDepth, usint batchSize,
+              usint plaintextModulus,
+              SecurityLevel stdLevel = HEStd_128_classic, usint ringDim = 0,
+              ScalingTechnique scalingTechnique = INVALID_RS_TECHNIQUE,
+              KeySwitchTechnique keySwitchTechnique = INVALID_KS_TECH,
+              SecretKeyDist secretKeyDist = UNIFORM_TERNARY,
+              usint firstModSize = 0, usint numLargeDigits = 0,
+              usint maxRelinSkDeg = 0);
 
 } // namespace pyOpenFHE_BGV
 
@@ -27,6 +27,18 @@ struct BGVCiphertext_pickle_suite : boost::python::pickle_suite {
   static boost::python::tuple getstate(const pyOpenFHE_BGV::BGVCiphertext &w);
   static void setstate(pyOpenFHE_BGV::BGVCiphertext &w,
                        boost::python::tuple state);
+  // bound as __reduce_ex__, for pickle protocol 5 out of band buffers
+  static boost::python::object reduce_ex(boost::python::object self,
+                                         int protocol);
+};
+
+struct BGVCryptoContext_pickle_suite : boost::python::pickle_suite {
+  static boost::python::tuple
+  getinitargs(const pyOpenFHE_BGV::BGVCryptoContext &w);
+  static boost::python::tuple
+  getstate(const pyOpenFHE_BGV::BGVCryptoContext &w);
+  static void setstate(pyOpenFHE_BGV::BGVCryptoContext &w,
+                       boost::python::tuple state);
 };
 
 } // namespace pyOpenFHE_BGV
@@ -4,13 +4,17 @@
 #define BGV_SERIALIZATION_OPENFHE_PYTHON_BINDINGS_H
 
 #include <complex>
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
 
 #include "openfhe.h"
+#include "utils/records.hpp"
+#include "utils/store.hpp"
 #include "utils/utils.hpp"
 
 #include "bgv/BGV_ciphertext_extension.hpp"
@@ -50,16 +54,42 @@ PrivateKey<DCRTPoly>
 DeserializeFromBytes_PrivateKey(boost::python::object py_buffer,
                                 const pyOpenFHE_BGV::SerType sertype);
 
+// serialize into a writable buffer the caller owns, returns the bytes written
+size_t SerializeInto_Ciphertext(const pyOpenFHE_BGV::BGVCiphertext &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_BGV::SerType sertype);
+size_t SerializeInto_PublicKey(const PublicKey<DCRTPoly> &obj,
+                               const boost::python::object &buffer,
+                               const pyOpenFHE_BGV::SerType sertype);
+size_t SerializeInto_PrivateKey(const PrivateKey<DCRTPoly> &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_BGV::SerType sertype);
+
 bool SerializeToFile_CryptoContext(const std::string &filename,
                                    const BGVCryptoContext &obj,
                                    const pyOpenFHE_BGV::SerType sertype);
-CryptoContext<DCRTPoly>
+BGVCryptoContext
 DeserializeFromFile_CryptoContext(const std::string &filename,
                                   const pyOpenFHE_BGV::SerType sertype);
+PyObject *SerializeToBytes_CryptoContext(const BGVCryptoContext &obj,
+                                         const pyOpenFHE_BGV::SerType sertype);
+BGVCryptoContext
+DeserializeFromBytes_CryptoContext(boost::python::object py_buffer,
+                                   const pyOpenFHE_BGV::SerType sertype);
 
 bool SerializeToFile_Ciphertext(const std::string &filename,
                                 const pyOpenFHE_BGV::BGVCiphertext &obj,
                                 const pyOpenFHE_BGV::SerType sertype);
+
+// with trim, only the 2 towers Decrypt uses are written
+PyObject *
+SerializeToBytes_TrimmedCiphertext(const pyOpenFHE_BGV::BGVCiphertext &obj,
+                                   const pyOpenFHE_BGV::SerType sertype,
+                                   bool trim);
+bool SerializeToFile_TrimmedCiphertext(const std::string &filename,
+                                       const pyOpenFHE_BGV::BGVCiphertext &obj,
+                                       const pyOpenFHE_BGV::SerType sertype,
+                                       bool trim);
 bool SerializeToFile_EvalMultKey_CryptoContext(
     BGVCryptoContext &self, const std::string &filename,
     const pyOpenFHE_BGV::SerType sertype);
@@ -89,6 +119,123 @@ bool DeserializeFromFile_EvalAutomorphismKey_CryptoContext(
     BGVCryptoContext &self, const std::string &filename,
     const pyOpenFHE_BGV::SerType sertype);
 
+/*
+One file with the context, the keys, and the EvalMult and EvalAutomorphism keys,
+always binary. sections is a list of section names to load, or None for all of them.
+*/
+bool SerializeToFile_Bundle(
+    const std::string &filename, BGVCryptoContext &self,
+    const boost::python::object &publicKey = boost::python::object(),
+    const boost::python::object &privateKey = boost::python::object());
+boost::python::dict DeserializeFromFile_Bundle(
+    const std::string &filename,
+    const boost::python::object &sections = boost::python::object());
+
+/*
+Lists of ciphertexts as one container with a table of shard offsets,
+serialized and deserialized in parallel. The SerType is recorded in the container.
+*/
+PyObject *SerializeToBytes_CiphertextList(const boost::python::list &ctxts,
+                                          const pyOpenFHE_BGV::SerType sertype);
+boost::python::list
+DeserializeFromBytes_CiphertextList(boost::python::object py_buffer);
+bool SerializeToFile_CiphertextList(const std::string &filename,
+                                    const boost::python::list &ctxts,
+                                    const pyOpenFHE_BGV::SerType sertype);
+boost::python::list
+DeserializeFromFile_CiphertextList(const std::string &filename);
+
+// symmetric-key encryption to the compact seeded format, see utils/seeded.hpp
+PyObject *EncryptSeeded_CryptoContext(BGVCryptoContext &self,
+                                      const PrivateKey<DCRTPoly> &privateKey,
+                                      const boost::python::list &pyvals);
+PyObject *EncryptSeeded2_CryptoContext(BGVCryptoContext &self,
+                                       const PrivateKey<DCRTPoly> &privateKey,
+                                       const ndarray &pyvals);
+pyOpenFHE_BGV::BGVCiphertext
+DeserializeFromBytes_SeededCiphertext(boost::python::object py_buffer);
+
+// the same record file streaming as for CKKS
+class CiphertextWriter {
+public:
+  CiphertextWriter(const std::string &filename,
+                   const pyOpenFHE_BGV::SerType sertype =
+                       pyOpenFHE_BGV::SerType::BINARY);
+
+  void write(const pyOpenFHE_BGV::BGVCiphertext &ctxt);
+  // serializes the whole list in parallel, then appends it in order
+  void writeList(const boost::python::list &py_ctxts);
+  void close();
+  size_t len() const { return writer.count(); }
+
+private:
+  pyOpenFHE_BGV::SerType sertype;
+  pyOpenFHE::RecordWriter writer;
+};
+
+class CiphertextReader {
+public:
+  CiphertextReader(const std::string &filename, int batchSize = 64,
+                   int prefetch = 2);
+
+  size_t len() const { return reader.count(); }
+  pyOpenFHE_BGV::BGVCiphertext getItem(long i) const;
+  boost::python::list read(long start, long count) const;
+
+  // iteration, which readBatch shares its position with
+  void restart();
+  pyOpenFHE_BGV::BGVCiphertext next();
+  // the next (up to) batchSize ciphertexts, empty at the end
+  boost::python::list readBatch();
+
+private:
+  pyOpenFHE::RecordReader reader;
+  pyOpenFHE::RecordDeserializer deserialize;
+  pyOpenFHE::RecordPrefetcher prefetcher;
+  std::vector<Ciphertext<DCRTPoly>> batch;
+  size_t position = 0;
+};
+
+bool SerializeToFile_CiphertextStore(const std::string &filename,
+                                     const boost::python::list &py_ctxts);
+
+// a ciphertext in a CiphertextStore, only materialized when get is called
+class CiphertextHandle {
+public:
+  CiphertextHandle(std::shared_ptr<pyOpenFHE::MappedCiphertextStore> store,
+                   size_t index)
+      : store(std::move(store)), index(index) {}
+
+  pyOpenFHE_BGV::BGVCiphertext get() const;
+  bool isResident() const { return store->resident(index); }
+  size_t getIndex() const { return index; }
+  size_t getTowersRemaining() const {
+    return store->entry(index).numTowers;
+  }
+
+private:
+  std::shared_ptr<pyOpenFHE::MappedCiphertextStore> store;
+  size_t index;
+};
+
+// random access with an LRU of materialized ciphertexts, as for CKKS
+class CiphertextStore {
+public:
+  CiphertextStore(const std::string &filename, const BGVCryptoContext &cc,
+                  int cacheSize = 64);
+
+  size_t len() const { return store->count(); }
+  CiphertextHandle getItem(long i) const;
+  pyOpenFHE_BGV::BGVCiphertext get(long i) const {
+    return getItem(i).get();
+  }
+  size_t residentCount() const { return store->residentCount(); }
+  void clearCache() { store->clearCache(); }
+
+private:
+  std::shared_ptr<pyOpenFHE::MappedCiphertextStore> store;
+};
+
 } // namespace pyOpenFHE_BGV
 
 #endif /* BGV_SERIALIZATION_OPENFHE_PYTHON_BINDINGS_H */
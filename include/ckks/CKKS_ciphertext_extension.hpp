@@ -141,6 +141,11 @@ CKKSCiphertext operator<<=(CKKSCiphertext &ctxt, int r);
 CKKSCiphertext CKKSRotateEvalAtIndex(CKKSCiphertext ctxt, int r);
 boost::python::list CKKSHoistedRotations(const CKKSCiphertext &ctxt,
                                          const boost::python::list &pylist);
+bool CKKSHasRotationKey(const CKKSCiphertext &ctxt, int r);
+std::vector<CKKSCiphertext>
+CKKSHoistedRotationsVector(const CKKSCiphertext &ctxt,
+                           const std::vector<int> &rotations);
+CKKSCiphertext CKKSSum(const boost::python::list &pylist);
 CKKSCiphertext CKKSMultiplySingletonDirect(CKKSCiphertext ctxt, double val);
 CKKSCiphertext CKKSMultiplySingletonIntDoubleAndAdd(const CKKSCiphertext &ctxt,
                                                     long int val);
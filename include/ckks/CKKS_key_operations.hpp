@@ -5,6 +5,8 @@
 #ifndef CKKS_ENCRYPTION_OPENFHE_PYTHON_BINDINGS_H
 #define CKKS_ENCRYPTION_OPENFHE_PYTHON_BINDINGS_H
 
+#include <map>
+
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
 
@@ -18,6 +20,12 @@ using namespace lbcrypto;
 namespace pyOpenFHE_CKKS {
 class CKKSCiphertext;
 
+// the arguments evalBootstrapSetup was last called with for one slot count
+struct BootstrapConfig {
+  std::vector<uint32_t> levelBudget;
+  std::vector<uint32_t> bsgsDim;
+};
+
 // CKKS-specific crypto context wrapper
 class CKKSCryptoContext {
 
@@ -25,6 +33,9 @@ public:
   // reminder to self that CryptoContext = shared_ptr<CryptoContextImpl>
   CryptoContext<DCRTPoly> context;
 
+  // default for pickling
+  CKKSCryptoContext() {};
+
   CKKSCryptoContext(CryptoContext<DCRTPoly> cc) : context(cc){};
 
   CKKSCryptoContext(const CKKSCryptoContext &cc) { context = cc.context; };
@@ -61,12 +72,47 @@ public:
 
   void evalPowerOf2RotationKeyGen(const PrivateKey<DCRTPoly> &);
 
+  // levelBudget = {4, 4}, bsgsDim = {0, 0}
   void evalBootstrapSetup();
+  // levelBudget is the number of levels spent on (CoeffsToSlots, SlotsToCoeffs),
+  // bsgsDim their baby-step giant-step dimensions, where 0 lets OpenFHE pick
+  void evalBootstrapSetup(const std::vector<uint32_t> &levelBudget,
+                          const std::vector<uint32_t> &bsgsDim);
+  // slots is the number of slots to bootstrap, a power of 2 no larger than the batch size
+  void evalBootstrapSetup(const std::vector<uint32_t> &levelBudget,
+                          const std::vector<uint32_t> &bsgsDim, uint32_t slots);
+  void evalBootstrapSetupList(const object &levelBudget);
+  void evalBootstrapSetupList2(const object &levelBudget, const object &bsgsDim);
+  void evalBootstrapSetupSlots(const object &levelBudget, const object &bsgsDim,
+                               const object &slots);
+  uint32_t bootstrapSlotsFor(uint32_t num_slots);
+  // every slot count evalBootstrapSetup has been called with on this context
+  std::map<uint32_t, BootstrapConfig> bootstrapConfigs();
   void evalBootstrapKeyGen(const PrivateKey<DCRTPoly> &);
+  void evalBootstrapKeyGenSlots(const PrivateKey<DCRTPoly> &, const object &slots);
+  list evalBootstrapSparseList(list, int);
+  pyOpenFHE_CKKS::CKKSCiphertext evalBootstrapSparse(pyOpenFHE_CKKS::CKKSCiphertext, int);
+  pyOpenFHE_CKKS::CKKSCiphertext evalBootstrapReplicated(pyOpenFHE_CKKS::CKKSCiphertext, int);
+  list evalBootstrapPacked(list, int);
   list evalBootstrapList(list);
   pyOpenFHE_CKKS::CKKSCiphertext evalBootstrap(pyOpenFHE_CKKS::CKKSCiphertext);
   list evalMetaBootstrapList(list);
   pyOpenFHE_CKKS::CKKSCiphertext evalMetaBootstrap(pyOpenFHE_CKKS::CKKSCiphertext);
+  void iteratedBootstrap(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &ctxts,
+                         int iterations, double errorScale, int numThreads,
+                         const PrivateKey<DCRTPoly> &privateKey,
+                         double targetPrecision,
+                         std::vector<std::vector<double>> &precisions);
+  list evalIteratedBootstrap(const list &ctxts, int iterations = 2,
+                             double errorScale = 1e-3, int numThreads = 0);
+  tuple evalIteratedBootstrapPrecision(const list &ctxts,
+                                       const PrivateKey<DCRTPoly> &privateKey,
+                                       int iterations = 2,
+                                       double errorScale = 1e-3,
+                                       double targetPrecision = 0.0,
+                                       int numThreads = 0);
+  tuple evalBootstrapActivation(const list &, const object &, int, double,
+                                const object &cacheKey = object());
 
   Plaintext encode(std::vector<double>);
 
@@ -82,6 +128,8 @@ public:
 
   ndarray decrypt(const PrivateKey<DCRTPoly> &,
                   pyOpenFHE_CKKS::CKKSCiphertext &);
+  std::vector<double> decryptValues(const PrivateKey<DCRTPoly> &,
+                                    const pyOpenFHE_CKKS::CKKSCiphertext &);
 
   size_t getBatchSize() {
     return context->GetEncodingParams()->GetBatchSize();
@@ -96,10 +144,36 @@ public:
   template <class Archive> void serialize(Archive &ar) { ar(context); };
 };
 
-CKKSCryptoContext genCKKSContext(usint multiplicativeDepth,
-                                 usint scalingFactorBits, usint batchSize,
-                                 SecurityLevel stdLevel = HEStd_128_classic,
-                                 usint ringDim = 0);
+/*
+The tuning parameters after ringDim are left at OpenFHE's defaults when they're
+INVALID_RS_TECHNIQUE / INVALID_KS_TECH / 0. numLargeDigits is dnum, the number of
+digits the key switching keys are split into with HYBRID key switching.
+*/
+CKKSCryptoContext
+genCKKSContext(usint multiplicativeDepth, usint scalingFactorBits,
+               usint batchSize, SecurityLevel stdLevel = HEStd_128_classic,
+               usint ringDim = 0,
+               ScalingTechnique scalingTechnique = INVALID_RS_TECHNIQUE,
+               KeySwitchTechnique keySwitchTechnique = INVALID_KS_TECH,
+               SecretKeyDist secretKeyDist = UNIFORM_TERNARY,
+               usint firstModSize = 0, usint numLargeDigits = 0,
+               usint maxRelinSkDeg = 0);
+
+/*
+Benchmarks bootstrapping for each candidate, which is either a levelBudget
+or a (levelBudget, bsgsDim) pair, and returns one dict per candidate.
+*/
+list tuneBootstrap(CKKSCryptoContext &cc, const PrivateKey<DCRTPoly> &privateKey,
+                   const list &candidates, int trials = 3);
+
+/*
+Generates a context for each candidate parameter set that reaches multiplicativeDepth
+at stdLevel, benchmarks it on workload, a dict of how many mults, rotations and
+bootstraps one step of the model does, and returns the results as a Pareto table.
+*/
+list tuneParameters(usint multiplicativeDepth, double precisionBits,
+                    SecurityLevel stdLevel = HEStd_128_classic,
+                    const object &workload = object(), int trials = 3);
 } // namespace pyOpenFHE_CKKS
 
 #endif
\ No newline at end of file
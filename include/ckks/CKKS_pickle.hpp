@@ -27,6 +27,15 @@ struct CKKSCiphertext_pickle_suite : boost::python::pickle_suite
         static boost::python::tuple getinitargs(const pyOpenFHE_CKKS::CKKSCiphertext& w);
         static boost::python::tuple getstate(const pyOpenFHE_CKKS::CKKSCiphertext& w);
         static void setstate(pyOpenFHE_CKKS::CKKSCiphertext& w, boost::python::tuple state);
+        // bound as __reduce_ex__, for pickle protocol 5 out of band buffers
+        static boost::python::object reduce_ex(boost::python::object self, int protocol);
+    };
+
+struct CKKSCryptoContext_pickle_suite : boost::python::pickle_suite 
+    {
+        static boost::python::tuple getinitargs(const pyOpenFHE_CKKS::CKKSCryptoContext& w);
+        static boost::python::tuple getstate(const pyOpenFHE_CKKS::CKKSCryptoContext& w);
+        static void setstate(pyOpenFHE_CKKS::CKKSCryptoContext& w, boost::python::tuple state);
     };
 
 }
@@ -19,7 +19,7 @@ using namespace boost::python::numpy;
 
 namespace pyOpenFHE_CKKS {
 
-    boost::python::list conv2d(const boost::python::list &py_shards, const ndarray &npfilters, int mtx_size, const ndarray &permutation);
+    boost::python::list conv2d(const boost::python::list &py_shards, const ndarray &npfilters, int mtx_size, const ndarray &permutation, int stride = 1, int gap = 1, bool multiplexed = false, int groups = 1);
 
 }
 
@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <complex>
+#include <functional>
 
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
@@ -24,6 +25,23 @@ namespace pyOpenFHE_CKKS {
     // should probably put this inside the OpenFHE namespace
     typedef typename boost::multi_array<pyOpenFHE_CKKS::CKKSCiphertext, 2> ciphertext_array2d;
     typedef typename boost::multi_array<pyOpenFHE_CKKS::CKKSCiphertext, 4> ciphertext_array4d;
+
+    // for each shard, sum_i (shard << i * step) * masks[i], shared by pool and upsample
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> rotate_mask_and_sum(const std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int step, const std::vector<std::vector<double>>& masks);
+    // same, with an explicit baby-step/giant-step split and masks generated per term
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> rotate_mask_and_sum_bsgs(const std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int baby_step, int num_baby_steps, int giant_step, int num_terms, const std::function<std::vector<double>(int)>& mask);
+
+    /*
+    Multiplexed layout, produced by pool(multiplexed=True) and consumed by conv2d, pool and linear via gap.
+    Each physical (mtx_size * gap)^2 channel holds gap^2 interleaved mtx_size^2 sub-channels:
+    pixel (r, c) of sub-channel q sits at physical (r * gap + a, c * gap + b), where q interleaves the bits of (a, b).
+    Channel slot p + num_physical_channels * q of a shard holds multiplexed_channel_index(p, q, ...),
+    which is chosen so that pooling leaves the permutation unchanged.
+    */
+    void check_multiplexed_gap(int gap);
+    int multiplexed_sub_channel(int row_offset, int col_offset, int gap);
+    // which of the num_channels channels in a shard (fewer than its slots means duplication) a slot holds
+    int multiplexed_channel_index(int physical_channel, int sub_channel, int num_physical_channels, int num_channels);
 }
 
 
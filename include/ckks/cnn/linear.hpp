@@ -21,7 +21,7 @@ using namespace boost::python::numpy;
 
 namespace pyOpenFHE_CKKS {
     
-    pyOpenFHE_CKKS::CKKSCiphertext linear(const boost::python::list &py_shards, const ndarray &npweights, const int mtx_size, const ndarray &permutation, const int pool_factor);
+    pyOpenFHE_CKKS::CKKSCiphertext linear(const boost::python::list &py_shards, const ndarray &npweights, const int mtx_size, const ndarray &permutation, const int pool_factor, const int gap = 1);
 
 }
 
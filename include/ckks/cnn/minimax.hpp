@@ -0,0 +1,30 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef HE_CNN_MINIMAX_H
+#define HE_CNN_MINIMAX_H
+
+// plain math for designing composite polynomial approximations, nothing homomorphic in here
+
+#include <vector>
+
+namespace pyOpenFHE_CKKS {
+
+    // multiplicative depth of EvalChebyshevSeries on [-1, 1] for a series of this degree
+    int chebyshevDepthByDegree(int degree);
+
+    /*
+    Chebyshev coefficients (in EvalChebyshevSeries form, over [-1, 1]) of a sequence of odd polynomials
+    whose composition approximates sign(x) to within 2^-alpha for epsilon <= |x| <= 1,
+    with the least total depth we can find. This is a search that takes up to minutes,
+    it's how the tables behind compositeSignStages were made and isn't called at runtime.
+    */
+    std::vector<std::vector<double>> compositeSignChebyshev(int alpha, double epsilon);
+
+    // the precomputed compositeSignChebyshev(alpha, 2^-alpha), for alpha = 8, 12 or 16
+    std::vector<std::vector<double>> compositeSignStages(int alpha);
+
+    // total depth of evaluating every stage in turn
+    int compositeDepth(const std::vector<std::vector<double>> &stages);
+}
+
+#endif
@@ -5,6 +5,8 @@
 
 #include <vector>
 #include <complex>
+#include <functional>
+#include <string>
 
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
@@ -19,6 +21,18 @@ using namespace boost::python::numpy;
 
 namespace pyOpenFHE_CKKS {
     boost::python::list fhe_gelu(const boost::python::list &py_shards, int degree, double bound);
+    boost::python::list fhe_sign(const boost::python::list &py_shards, int alpha);
+    boost::python::list fhe_relu(const boost::python::list &py_shards, int alpha, double bound = 1.0);
+    boost::python::list activation(const boost::python::list &py_shards, const boost::python::object &fn, int degree, double bound, const boost::python::object &cacheKey = boost::python::object());
+
+    // Chebyshev coefficients of fn (an activation name or a callable) over [lower, upper],
+    // cached by (name, degree, interval), or for a callable by (cacheKey, degree, interval) if cacheKey isn't None
+    std::vector<double> activationCoefficients(const boost::python::object &fn, int degree, double lower, double upper, const boost::python::object &cacheKey = boost::python::object());
+    // multiplicative depth EvalChebyshevSeries consumes for these coefficients
+    int chebyshevSeriesDepth(const std::vector<double> &coefficients, double lower, double upper);
+    // evaluates the series on every shard in parallel, throws if there aren't enough towers.
+    // doesn't touch python, so callers can release the GIL around it
+    void evalChebyshevShards(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &shards, const std::vector<double> &coefficients, double lower, double upper);
 }
 
 #endif
\ No newline at end of file
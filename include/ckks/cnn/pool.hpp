@@ -19,7 +19,8 @@ using namespace boost::python::numpy;
 
 namespace pyOpenFHE_CKKS {
 
-    boost::python::list pool(const boost::python::list &py_shards, int mtx_size, bool conv);
+    boost::python::list pool(const boost::python::list &py_shards, int mtx_size, bool conv, int gap = 1, bool multiplexed = false);
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> pool_strided_downsample(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int mtx_size, int gap = 1, bool multiplexed = false);
 }
 
 #endif
@@ -4,13 +4,17 @@
 #define OPENFHE_PYTHON_SERIALIZATION_H
 
 #include <complex>
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
 
 #include "openfhe.h"
+#include "utils/records.hpp"
+#include "utils/store.hpp"
 #include "utils/utils.hpp"
 
 #include "ckks/CKKS_ciphertext_extension.hpp"
@@ -50,16 +54,42 @@ PrivateKey<DCRTPoly>
 DeserializeFromBytes_PrivateKey(boost::python::object py_buffer,
                                 const pyOpenFHE_CKKS::SerType sertype);
 
+// serialize into a writable buffer the caller owns, returns the bytes written
+size_t SerializeInto_Ciphertext(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_CKKS::SerType sertype);
+size_t SerializeInto_PublicKey(const PublicKey<DCRTPoly> &obj,
+                               const boost::python::object &buffer,
+                               const pyOpenFHE_CKKS::SerType sertype);
+size_t SerializeInto_PrivateKey(const PrivateKey<DCRTPoly> &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_CKKS::SerType sertype);
+
 bool SerializeToFile_CryptoContext(const std::string &filename,
                                    const CKKSCryptoContext &obj,
                                    const pyOpenFHE_CKKS::SerType sertype);
-CryptoContext<DCRTPoly>
+CKKSCryptoContext
 DeserializeFromFile_CryptoContext(const std::string &filename,
                                   const pyOpenFHE_CKKS::SerType sertype);
+PyObject *SerializeToBytes_CryptoContext(const CKKSCryptoContext &obj,
+                                         const pyOpenFHE_CKKS::SerType sertype);
+CKKSCryptoContext
+DeserializeFromBytes_CryptoContext(boost::python::object py_buffer,
+                                   const pyOpenFHE_CKKS::SerType sertype);
 
 bool SerializeToFile_Ciphertext(const std::string &filename,
                                 const pyOpenFHE_CKKS::CKKSCiphertext &obj,
                                 const pyOpenFHE_CKKS::SerType sertype);
+
+// with trim, only the towers needed to decrypt values up to maxMagnitude are written
+PyObject *
+SerializeToBytes_TrimmedCiphertext(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+                                   const pyOpenFHE_CKKS::SerType sertype,
+                                   bool trim, double maxMagnitude = 1.0);
+bool SerializeToFile_TrimmedCiphertext(
+    const std::string &filename, const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+    const pyOpenFHE_CKKS::SerType sertype, bool trim,
+    double maxMagnitude = 1.0);
 bool SerializeToFile_EvalMultKey_CryptoContext(
     CKKSCryptoContext &self, const std::string &filename,
     const pyOpenFHE_CKKS::SerType sertype);
@@ -89,6 +119,142 @@ bool DeserializeFromFile_EvalAutomorphismKey_CryptoContext(
     CKKSCryptoContext &self, const std::string &filename,
     const pyOpenFHE_CKKS::SerType sertype);
 
+// bootstrapping setups plus the EvalMult and EvalAutomorphism keys, always binary
+bool SerializeToFile_BootstrapState_CryptoContext(CKKSCryptoContext &self,
+                                                  const std::string &filename);
+bool DeserializeFromFile_BootstrapState_CryptoContext(
+    CKKSCryptoContext &self, const std::string &filename);
+
+/*
+One file with the context, the keys, and the EvalMult and EvalAutomorphism keys,
+always binary. sections is a list of section names to load, or None for all of them.
+*/
+bool SerializeToFile_Bundle(
+    const std::string &filename, CKKSCryptoContext &self,
+    const boost::python::object &publicKey = boost::python::object(),
+    const boost::python::object &privateKey = boost::python::object());
+boost::python::dict DeserializeFromFile_Bundle(
+    const std::string &filename,
+    const boost::python::object &sections = boost::python::object());
+
+/*
+Lists of ciphertexts as one container with a table of shard offsets,
+serialized and deserialized in parallel. The SerType is recorded in the container.
+*/
+PyObject *SerializeToBytes_CiphertextList(const boost::python::list &ctxts,
+                                          const pyOpenFHE_CKKS::SerType sertype);
+boost::python::list
+DeserializeFromBytes_CiphertextList(boost::python::object py_buffer);
+bool SerializeToFile_CiphertextList(const std::string &filename,
+                                    const boost::python::list &ctxts,
+                                    const pyOpenFHE_CKKS::SerType sertype);
+boost::python::list
+DeserializeFromFile_CiphertextList(const std::string &filename);
+
+/*
+Symmetric-key encryption straight to bytes, with the uniformly random half of the
+ciphertext replaced by a seed it's expanded from on deserialization.
+*/
+PyObject *EncryptSeeded_CryptoContext(CKKSCryptoContext &self,
+                                      const PrivateKey<DCRTPoly> &privateKey,
+                                      const boost::python::list &pyvals);
+PyObject *EncryptSeeded2_CryptoContext(CKKSCryptoContext &self,
+                                       const PrivateKey<DCRTPoly> &privateKey,
+                                       const ndarray &pyvals);
+pyOpenFHE_CKKS::CKKSCiphertext
+DeserializeFromBytes_SeededCiphertext(boost::python::object py_buffer);
+
+/*
+Streams ciphertexts into a record file (see utils/records.hpp), for datasets that
+don't fit in memory or would otherwise be millions of little files.
+*/
+class CiphertextWriter {
+public:
+  CiphertextWriter(const std::string &filename,
+                   const pyOpenFHE_CKKS::SerType sertype =
+                       pyOpenFHE_CKKS::SerType::BINARY);
+
+  void write(const pyOpenFHE_CKKS::CKKSCiphertext &ctxt);
+  // serializes the whole list in parallel, then appends it in order
+  void writeList(const boost::python::list &py_ctxts);
+  void close();
+  size_t len() const { return writer.count(); }
+
+private:
+  pyOpenFHE_CKKS::SerType sertype;
+  pyOpenFHE::RecordWriter writer;
+};
+
+/*
+Reads a record file through mmap, by index or front to back. Iterating deserializes
+batchSize ciphertexts at a time, prefetch batches ahead on background threads.
+*/
+class CiphertextReader {
+public:
+  CiphertextReader(const std::string &filename, int batchSize = 64,
+                   int prefetch = 2);
+
+  size_t len() const { return reader.count(); }
+  pyOpenFHE_CKKS::CKKSCiphertext getItem(long i) const;
+  boost::python::list read(long start, long count) const;
+
+  // iteration, which readBatch shares its position with
+  void restart();
+  pyOpenFHE_CKKS::CKKSCiphertext next();
+  // the next (up to) batchSize ciphertexts, empty at the end
+  boost::python::list readBatch();
+
+private:
+  pyOpenFHE::RecordReader reader;
+  pyOpenFHE::RecordDeserializer deserialize;
+  pyOpenFHE::RecordPrefetcher prefetcher;
+  std::vector<Ciphertext<DCRTPoly>> batch;
+  size_t position = 0;
+};
+
+bool SerializeToFile_CiphertextStore(const std::string &filename,
+                                     const boost::python::list &py_ctxts);
+
+// a ciphertext in a CiphertextStore, only materialized when get is called
+class CiphertextHandle {
+public:
+  CiphertextHandle(std::shared_ptr<pyOpenFHE::MappedCiphertextStore> store,
+                   size_t index)
+      : store(std::move(store)), index(index) {}
+
+  pyOpenFHE_CKKS::CKKSCiphertext get() const;
+  bool isResident() const { return store->resident(index); }
+  size_t getIndex() const { return index; }
+  size_t getTowersRemaining() const {
+    return store->entry(index).numTowers;
+  }
+
+private:
+  std::shared_ptr<pyOpenFHE::MappedCiphertextStore> store;
+  size_t index;
+};
+
+/*
+Random access to a file written by SerializeToFile_CiphertextStore (see utils/store.hpp).
+Indexing hands out handles, the cacheSize most recently materialized ciphertexts stay alive.
+*/
+class CiphertextStore {
+public:
+  CiphertextStore(const std::string &filename, const CKKSCryptoContext &cc,
+                  int cacheSize = 64);
+
+  size_t len() const { return store->count(); }
+  CiphertextHandle getItem(long i) const;
+  pyOpenFHE_CKKS::CKKSCiphertext get(long i) const {
+    return getItem(i).get();
+  }
+  size_t residentCount() const { return store->residentCount(); }
+  void clearCache() { store->clearCache(); }
+
+private:
+  std::shared_ptr<pyOpenFHE::MappedCiphertextStore> store;
+};
+
 } // namespace pyOpenFHE_CKKS
 
 #endif /* OPENFHE_PYTHON_SERIALIZATION_H */
\ No newline at end of file
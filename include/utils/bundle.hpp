@@ -0,0 +1,89 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_BUNDLE_H
+#define OpenFHE_PYTHON_BUNDLE_H
+
+/*
+A bundle is a single file holding a CryptoContext and everything generated for it:
+    the magic bytes, a version, the scheme it was made with,
+    a table of contents with an (offset, length) for every section kind, and
+    the sections themselves, each OpenFHE BINARY data starting on a page boundary.
+Absent sections have length 0. Page alignment means a section nobody asks for
+is never read from disk once the file is memory mapped.
+This only knows about the layout, the schemes fill in and read out the sections.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "utils/mmap.hpp"
+
+namespace pyOpenFHE {
+
+enum class BundleSection : uint32_t {
+  CONTEXT,
+  PUBLIC_KEY,
+  PRIVATE_KEY,
+  EVAL_MULT_KEYS,
+  EVAL_AUTOMORPHISM_KEYS,
+  NUM_SECTIONS
+};
+
+// name of the section in error messages and in what the loaders return
+const char *bundleSectionName(BundleSection section);
+BundleSection bundleSectionByName(const std::string &name);
+
+class BundleWriter {
+public:
+  BundleWriter(const std::string &filename, uint32_t scheme);
+
+  // serialize writes the section to the ostream it is given
+  template <typename F> void addSection(BundleSection section, F serialize) {
+    beginSection(section);
+    serialize(file);
+    endSection(section);
+  }
+
+  // fills in the table of contents, nothing is valid until this is called
+  void finish();
+
+private:
+  void beginSection(BundleSection section);
+  void endSection(BundleSection section);
+
+  std::string filename;
+  std::ofstream file;
+  uint64_t offsets[(size_t)BundleSection::NUM_SECTIONS] = {};
+  uint64_t lengths[(size_t)BundleSection::NUM_SECTIONS] = {};
+};
+
+class BundleReader {
+public:
+  // checks the header and table of contents, but doesn't touch any section
+  BundleReader(const std::string &filename, uint32_t scheme);
+
+  bool has(BundleSection section) const;
+
+  // deserialize reads the section from the istream it is given
+  template <typename F> void readSection(BundleSection section, F deserialize) {
+    size_t i = checkedIndex(section);
+    // the file is mapped for random access, so read ahead within this section only
+    file.willNeed(offsets[i], lengths[i]);
+    MemoryIStream is(file.data() + offsets[i], lengths[i]);
+    deserialize(is);
+  }
+
+private:
+  size_t checkedIndex(BundleSection section) const;
+
+  std::string filename;
+  MappedFile file;
+  uint64_t offsets[(size_t)BundleSection::NUM_SECTIONS] = {};
+  uint64_t lengths[(size_t)BundleSection::NUM_SECTIONS] = {};
+};
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_BUNDLE_H */
@@ -0,0 +1,104 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_BYTES_STREAM_H
+#define OpenFHE_PYTHON_BYTES_STREAM_H
+
+// ostreams that OpenFHE can serialize into without going through a std::string
+
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+
+#include <boost/python.hpp>
+
+#include "utils/utils.hpp"
+
+namespace pyOpenFHE {
+
+/*
+Writes straight into a Python bytes object, growing it geometrically.
+The bytes object isn't visible to Python until release, so resizing it in place is fine,
+but it is Python memory, so the GIL has to be held throughout.
+*/
+class BytesStreambuf : public std::streambuf {
+public:
+  BytesStreambuf();
+  ~BytesStreambuf();
+  BytesStreambuf(const BytesStreambuf &) = delete;
+  BytesStreambuf &operator=(const BytesStreambuf &) = delete;
+
+  // shrinks the bytes to what was written and hands over the reference
+  PyObject *release();
+
+protected:
+  int_type overflow(int_type ch) override;
+  std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+private:
+  // pbase moves along with pptr, since setp is how we advance past 2GB
+  size_t used() const;
+  void grow(size_t minimum);
+
+  PyObject *bytes = nullptr;
+};
+
+class BytesOStream : public std::ostream {
+public:
+  BytesOStream();
+  PyObject *release() { return buffer.release(); }
+
+private:
+  BytesStreambuf buffer;
+};
+
+/*
+Writes into memory we don't own. Whatever doesn't fit is counted rather than written,
+so the caller can say how big the buffer would have had to be.
+*/
+class FixedStreambuf : public std::streambuf {
+public:
+  FixedStreambuf(char *data, size_t size);
+
+  // everything we were asked to write, including what didn't fit
+  size_t requested() const { return (pptr() - begin) + dropped; }
+
+protected:
+  int_type overflow(int_type ch) override;
+  std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+private:
+  char *begin;
+  size_t dropped = 0;
+};
+
+class FixedOStream : public std::ostream {
+public:
+  FixedOStream(char *data, size_t size);
+  size_t requested() const { return buffer.requested(); }
+
+private:
+  FixedStreambuf buffer;
+};
+
+// serialize writes to the ostream it is given, straight into a new bytes object
+template <typename F> PyObject *serializeToPyBytes(F serialize) {
+  BytesOStream os;
+  serialize(os);
+  return os.release();
+}
+
+void checkSerializedFits(size_t requested, size_t capacity);
+
+// serialize writes into any writable buffer, returns the number of bytes written
+template <typename F>
+size_t serializeInto(const boost::python::object &buffer, F serialize) {
+  ScopedBuffer view(buffer, true);
+  FixedOStream os(view.writableData(), view.size());
+  serialize(os);
+  checkSerializedFits(os.requested(), view.size());
+  return os.requested();
+}
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_BYTES_STREAM_H */
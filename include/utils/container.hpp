@@ -0,0 +1,77 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_CONTAINER_H
+#define OpenFHE_PYTHON_CONTAINER_H
+
+/*
+A container holds a list of shards (e.g. the ciphertexts of one conv2d output):
+    the magic bytes, a version, the scheme, the SerType of the shards, the number of shards,
+    a table with an (offset, length) for every shard, and the shards back to back.
+The table lets readers deserialize every shard independently, and so in parallel.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+namespace pyOpenFHE {
+
+/*
+serialize(i, os) writes shard i to os. The shards are serialized in parallel,
+each into its own buffer, which writeContainer then writes out in order.
+Nothing in here touches Python, so callers can drop the GIL around it.
+*/
+template <typename F>
+std::vector<std::string> serializeShards(size_t count, F serialize) {
+  std::vector<std::string> shards(count);
+  std::string error;
+
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int)count; ++i) {
+    try {
+      std::ostringstream ss;
+      serialize(i, ss);
+      shards[i] = ss.str();
+    } catch (const std::exception &e) {
+#pragma omp critical
+      if (error.empty()) {
+        error = e.what();
+      }
+    }
+  }
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+  return shards;
+}
+
+void writeContainer(std::ostream &os, uint32_t scheme, uint32_t sertype,
+                    const std::vector<std::string> &shards);
+
+// a container in memory we don't own, checked against the scheme we expect
+class ContainerReader {
+public:
+  ContainerReader(const char *data, size_t size, uint32_t scheme,
+                  const std::string &source);
+
+  size_t count() const { return offsets.size(); }
+  uint32_t serType() const { return sertype; }
+  const char *shardData(size_t i) const { return data + offsets[i]; }
+  size_t shardSize(size_t i) const { return lengths[i]; }
+
+private:
+  const char *data;
+  uint32_t sertype;
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> lengths;
+};
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_CONTAINER_H */
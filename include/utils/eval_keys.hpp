@@ -0,0 +1,44 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_EVAL_KEYS_H
+#define OpenFHE_PYTHON_EVAL_KEYS_H
+
+/*
+OpenFHE keeps the EvalMult and EvalAutomorphism keys of every context in process-wide
+maps keyed by the tag of the secret key, and nothing guards them. We only read or write
+them with the GIL held. These copy one context's keys out, in the same map types
+SerializeEvalMultKey / SerializeEvalAutomorphismKey write, so Serial::Serialize on a copy
+reads back with DeserializeEvalMultKey / DeserializeEvalAutomorphismKey, and the copy
+can be serialized with the GIL released.
+*/
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "openfhe.h"
+
+namespace pyOpenFHE {
+
+using EvalMultKeyMap =
+    std::map<std::string,
+             std::vector<lbcrypto::EvalKey<lbcrypto::DCRTPoly>>>;
+using EvalAutomorphismKeyMap = std::map<
+    std::string,
+    std::shared_ptr<std::map<uint32_t, lbcrypto::EvalKey<lbcrypto::DCRTPoly>>>>;
+
+// call these with the GIL held
+EvalMultKeyMap
+contextEvalMultKeys(const lbcrypto::CryptoContext<lbcrypto::DCRTPoly> &cc);
+EvalAutomorphismKeyMap contextEvalAutomorphismKeys(
+    const lbcrypto::CryptoContext<lbcrypto::DCRTPoly> &cc);
+
+// the rotation keys of one key tag, null if there aren't any
+std::shared_ptr<std::map<uint32_t, lbcrypto::EvalKey<lbcrypto::DCRTPoly>>>
+taggedEvalAutomorphismKeys(const std::string &tag);
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_EVAL_KEYS_H */
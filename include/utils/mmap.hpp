@@ -0,0 +1,58 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_MMAP_H
+#define OpenFHE_PYTHON_MMAP_H
+
+// read-only views of serialized data that OpenFHE can deserialize from
+// without copying it into a std::string first
+
+#include <cstddef>
+#include <istream>
+#include <streambuf>
+#include <string>
+
+namespace pyOpenFHE {
+
+// a read-only std::streambuf over memory we don't own
+class MemoryStreambuf : public std::streambuf {
+public:
+  MemoryStreambuf(const char *data, size_t size);
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override;
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
+
+// an istream over memory we don't own, which has to outlive it
+class MemoryIStream : public std::istream {
+public:
+  MemoryIStream(const char *data, size_t size);
+
+private:
+  MemoryStreambuf buffer;
+};
+
+// a whole file mapped read-only into memory, unmapped when this goes out of scope
+class MappedFile {
+public:
+  // sequential tells the kernel to read ahead aggressively and drop pages behind us
+  explicit MappedFile(const std::string &filename, bool sequential = true);
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const { return mapped; }
+  size_t size() const { return length; }
+
+  // asks the kernel to start reading [offset, offset + count) in, without waiting for it
+  void willNeed(size_t offset, size_t count) const;
+
+private:
+  const char *mapped = nullptr;
+  size_t length = 0;
+};
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_MMAP_H */
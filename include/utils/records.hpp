@@ -0,0 +1,126 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_RECORDS_H
+#define OpenFHE_PYTHON_RECORDS_H
+
+/*
+A record file holds any number of serialized ciphertexts, appended one at a time:
+    the magic bytes, a version, the scheme, the SerType of the records,
+    then every record as a uint64 length followed by that many bytes,
+    then once the writer is closed, an (offset, length) index of the records
+    and a trailer with the position of the index, the number of records and more magic bytes.
+A file whose writer never got to close it has no index, readers find the records
+by walking the lengths instead, and drop a last record that was cut short.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "openfhe.h"
+
+#include "utils/mmap.hpp"
+
+namespace pyOpenFHE {
+
+class RecordWriter {
+public:
+  RecordWriter(const std::string &filename, uint32_t scheme, uint32_t sertype);
+  // closes the file if close wasn't called, any error is lost
+  ~RecordWriter();
+  RecordWriter(const RecordWriter &) = delete;
+  RecordWriter &operator=(const RecordWriter &) = delete;
+
+  void append(const std::string &record);
+  // writes the index, nothing can be appended afterwards
+  void close();
+
+  size_t count() const { return offsets.size(); }
+  bool closed() const { return !file.is_open(); }
+
+private:
+  void check(const char *what);
+
+  std::string filename;
+  std::ofstream file;
+  uint64_t position = 0;
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> lengths;
+};
+
+class RecordReader {
+public:
+  RecordReader(const std::string &filename, uint32_t scheme);
+
+  size_t count() const { return offsets.size(); }
+  uint32_t serType() const { return sertype; }
+  const char *recordData(size_t i) const { return file.data() + offsets[i]; }
+  size_t recordSize(size_t i) const { return lengths[i]; }
+
+  // starts paging in records [first, last) in the background
+  void willNeed(size_t first, size_t last) const;
+
+private:
+  bool readIndex();
+  void scanRecords(uint64_t position);
+
+  std::string filename;
+  MappedFile file;
+  uint32_t sertype;
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> lengths;
+};
+
+using RecordDeserializer =
+    std::function<lbcrypto::Ciphertext<lbcrypto::DCRTPoly>(const char *,
+                                                           size_t)>;
+
+// deserializes records [first, first + count) on up to numThreads threads
+// (all of OpenMP's by default), doesn't touch Python
+std::vector<lbcrypto::Ciphertext<lbcrypto::DCRTPoly>>
+readRecords(const RecordReader &reader, const RecordDeserializer &deserialize,
+            size_t first, size_t count, int numThreads = 0);
+
+/*
+Keeps up to depth batches of records being deserialized on background threads,
+ahead of whoever is calling next, so reading from disk and deserializing overlap
+with the work done on the ciphertexts. Each background batch is deserialized on
+its one thread, the cores belong to whatever OpenMP work the caller is doing.
+Deserializing looks the context up in CryptoContextFactory, so nothing else should
+be registering contexts while batches are in flight.
+*/
+class RecordPrefetcher {
+public:
+  RecordPrefetcher(const RecordReader &reader, RecordDeserializer deserialize,
+                   size_t batchSize, size_t depth);
+  // waits for the batches in flight, they still reference the reader
+  ~RecordPrefetcher();
+  RecordPrefetcher(const RecordPrefetcher &) = delete;
+  RecordPrefetcher &operator=(const RecordPrefetcher &) = delete;
+
+  // the next batch in file order, empty once every record has been read
+  std::vector<lbcrypto::Ciphertext<lbcrypto::DCRTPoly>> next();
+  // drops whatever is in flight and starts again from record first
+  void restart(size_t first);
+
+private:
+  void schedule();
+  void drain();
+
+  const RecordReader &reader;
+  RecordDeserializer deserialize;
+  size_t batchSize;
+  size_t depth;
+  size_t scheduled = 0;
+  std::deque<std::future<std::vector<lbcrypto::Ciphertext<lbcrypto::DCRTPoly>>>>
+      pending;
+};
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_RECORDS_H */
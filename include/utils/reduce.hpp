@@ -0,0 +1,71 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_REDUCE_H
+#define OpenFHE_PYTHON_REDUCE_H
+
+// scheme-agnostic reductions over ciphertext wrappers
+// anything with an operator+= works, so this covers both CKKSCiphertext and
+// BGVCiphertext
+
+#include <stdexcept>
+#include <vector>
+
+#include <omp.h>
+
+namespace pyOpenFHE {
+
+/*
+Sums several groups of ciphertexts at once with a pairwise tree, so the
+latency is log2(group_size) additions instead of group_size - 1.
+Term k of group g lives at terms[g * group_stride + k * term_stride],
+which lets callers reduce over whichever axis of their flattened
+multi-index they like without reshuffling anything first.
+
+Every level of the tree is a single parallel loop over all groups at once,
+so small groups still keep every core busy.
+The contents of terms are clobbered.
+*/
+template <typename T>
+std::vector<T> parallelTreeSumGroups(std::vector<T> &terms, int num_groups,
+                                     int group_size, int group_stride,
+                                     int term_stride) {
+  if (group_size <= 0) {
+    throw std::runtime_error("Cannot sum an empty list of ciphertexts");
+  }
+
+  for (int gap = 1; gap < group_size; gap *= 2) {
+    // number of pairs being added at this level of the tree
+    int num_pairs = (group_size + gap - 1) / (2 * gap);
+
+#pragma omp parallel for collapse(2)
+    for (int g = 0; g < num_groups; ++g) {
+      for (int p = 0; p < num_pairs; ++p) {
+        int k = p * 2 * gap;
+        terms[g * group_stride + k * term_stride] +=
+            terms[g * group_stride + (k + gap) * term_stride];
+      }
+    }
+  }
+
+  std::vector<T> sums(num_groups);
+  for (int g = 0; g < num_groups; ++g) {
+    sums[g] = terms[g * group_stride];
+  }
+  return sums;
+}
+
+// contiguous groups, i.e. group g is terms[g * group_size, (g+1) * group_size)
+template <typename T>
+std::vector<T> parallelTreeSumGroups(std::vector<T> &terms, int num_groups,
+                                     int group_size) {
+  return parallelTreeSumGroups(terms, num_groups, group_size, group_size, 1);
+}
+
+// a single group containing all of terms
+template <typename T> T parallelTreeSum(std::vector<T> &terms) {
+  return parallelTreeSumGroups(terms, 1, (int)terms.size())[0];
+}
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_REDUCE_H */
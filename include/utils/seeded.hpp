@@ -0,0 +1,55 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_SEEDED_H
+#define OpenFHE_PYTHON_SEEDED_H
+
+/*
+A symmetric-key encryption is (b, a) with a uniformly random and b = -a*s + e + m.
+If a is expanded from a short seed instead, only b and the seed need to be sent,
+which is about half the size. The seed is public, a is only pseudorandom
+in the same sense as every other PRNG output OpenFHE uses.
+
+A seeded ciphertext is written as
+    the magic bytes, a version, the scheme, the seed, then OpenFHE BINARY
+    data for the ciphertext with only b in it.
+*/
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "openfhe.h"
+
+namespace pyOpenFHE {
+
+using PRNGSeed = std::array<uint8_t, 32>;
+
+// from std::random_device, so every ciphertext gets its own
+PRNGSeed freshSeed();
+
+// a uniform DCRTPoly in EVALUATION format over params, a deterministic function of seed
+lbcrypto::DCRTPoly
+expandUniform(const PRNGSeed &seed,
+              const std::shared_ptr<lbcrypto::DCRTPoly::Params> &params);
+
+// swaps a for expandUniform(seed) and fixes up b, so ctxt still decrypts to the same thing
+void reseedCiphertext(lbcrypto::Ciphertext<lbcrypto::DCRTPoly> &ctxt,
+                      const lbcrypto::PrivateKey<lbcrypto::DCRTPoly> &privateKey,
+                      const PRNGSeed &seed);
+
+// a copy of ctxt with only b, and the inverse
+lbcrypto::Ciphertext<lbcrypto::DCRTPoly>
+dropUniform(const lbcrypto::Ciphertext<lbcrypto::DCRTPoly> &ctxt);
+void restoreUniform(lbcrypto::Ciphertext<lbcrypto::DCRTPoly> &ctxt,
+                    const PRNGSeed &seed);
+
+void writeSeededHeader(std::ostream &os, uint32_t scheme, const PRNGSeed &seed);
+// advances ptr past the header
+PRNGSeed readSeededHeader(const char *&ptr, const char *end, uint32_t scheme,
+                          const std::string &source);
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_SEEDED_H */
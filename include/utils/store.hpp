@@ -0,0 +1,94 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#ifndef OpenFHE_PYTHON_STORE_H
+#define OpenFHE_PYTHON_STORE_H
+
+/*
+A ciphertext store keeps the RNS limbs of every ciphertext as raw uint64 words,
+each limb starting on a page boundary, so one can be copied straight out of the
+mapped file without parsing anything:
+    a header with the magic bytes, a version, the scheme, the ring dimension,
+    the moduli of the context, the number of ciphertexts and where the index is,
+    then for every ciphertext its limbs (element by element, tower by tower) and its key tag,
+    then the index, with the offset and metadata of every ciphertext.
+Ciphertexts at lower levels use a prefix of the moduli, which is all OpenFHE produces.
+The metadata map of a ciphertext isn't stored.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "openfhe.h"
+
+#include "utils/mmap.hpp"
+
+namespace pyOpenFHE {
+
+void writeCiphertextStore(
+    const std::string &filename, uint32_t scheme,
+    const std::vector<lbcrypto::Ciphertext<lbcrypto::DCRTPoly>> &ctxts);
+
+// the fixed size index entry of one ciphertext
+struct StoreEntry {
+  uint64_t offset;
+  uint32_t numElements;
+  uint32_t numTowers;
+  uint32_t level;
+  uint32_t noiseScaleDeg;
+  uint32_t slots;
+  uint32_t encodingType;
+  double scalingFactor;
+  uint64_t scalingFactorInt;
+  uint64_t tagOffset;
+  uint64_t tagLength;
+};
+
+/*
+Materializes ciphertexts from the mapped file on demand, and keeps the cacheSize
+most recently used ones alive, so memory use follows the working set and not
+the size of the store. Safe to call from several threads.
+*/
+class MappedCiphertextStore {
+public:
+  MappedCiphertextStore(const std::string &filename,
+                        const lbcrypto::CryptoContext<lbcrypto::DCRTPoly> &cc,
+                        uint32_t scheme, size_t cacheSize);
+
+  size_t count() const { return entries.size(); }
+  const StoreEntry &entry(size_t i) const { return entries.at(i); }
+
+  lbcrypto::Ciphertext<lbcrypto::DCRTPoly> get(size_t i);
+  bool resident(size_t i) const;
+  size_t residentCount() const;
+  void clearCache();
+
+private:
+  lbcrypto::Ciphertext<lbcrypto::DCRTPoly> materialize(size_t i) const;
+
+  std::string filename;
+  MappedFile file;
+  lbcrypto::CryptoContext<lbcrypto::DCRTPoly> cc;
+  uint32_t ringDim;
+  // params[k] has the first k + 1 towers of the context
+  std::vector<std::shared_ptr<lbcrypto::DCRTPoly::Params>> params;
+  std::vector<StoreEntry> entries;
+
+  size_t cacheSize;
+  mutable std::mutex mutex;
+  // most recently used at the front
+  std::list<size_t> order;
+  std::unordered_map<
+      size_t, std::pair<lbcrypto::Ciphertext<lbcrypto::DCRTPoly>,
+                        std::list<size_t>::iterator>>
+      cache;
+};
+
+} // namespace pyOpenFHE
+
+#endif /* OpenFHE_PYTHON_STORE_H */
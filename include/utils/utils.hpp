@@ -4,6 +4,7 @@
 #define OpenFHE_PYTHON_UTILS_H
 
 #include <complex>
+#include <string>
 #include <vector>
 
 #include "boost/multi_array.hpp"
@@ -59,6 +60,42 @@ std::vector<int64_t> pythonListToCppLongIntVector(const list &pylist);
 
 std::vector<int64_t> numpyListToCppLongIntVector(const ndarray &nplist);
 
+// levelBudget and bsgsDim for EvalBootstrapSetup, which are both pairs
+// (CoeffsToSlots, SlotsToCoeffs) with every entry at least minimum
+std::vector<uint32_t> pythonListToBootstrapPair(const object &pylist,
+                                                const std::string &name,
+                                                int minimum);
+
+// releases the GIL until it goes out of scope, so other Python threads can run
+// while we're busy in C++. Don't touch any Python objects while one is alive.
+class ScopedGILRelease {
+public:
+  ScopedGILRelease() : state(PyEval_SaveThread()) {}
+  ~ScopedGILRelease() { PyEval_RestoreThread(state); }
+  ScopedGILRelease(const ScopedGILRelease &) = delete;
+  ScopedGILRelease &operator=(const ScopedGILRelease &) = delete;
+
+private:
+  PyThreadState *state;
+};
+
+// a view of any contiguous object with the buffer protocol (bytes, bytearray,
+// memoryview, PickleBuffer, ...), released when it goes out of scope
+class ScopedBuffer {
+public:
+  explicit ScopedBuffer(const object &obj, bool writable = false);
+  ~ScopedBuffer() { PyBuffer_Release(&view); }
+  ScopedBuffer(const ScopedBuffer &) = delete;
+  ScopedBuffer &operator=(const ScopedBuffer &) = delete;
+
+  const char *data() const { return static_cast<const char *>(view.buf); }
+  char *writableData() { return static_cast<char *>(view.buf); }
+  size_t size() const { return view.len; }
+
+private:
+  Py_buffer view;
+};
+
 } // namespace pyOpenFHE
 
 std::vector<int> sumOfPo2s(int);
@@ -67,6 +104,8 @@ void tileVector(std::vector<double> &vals, unsigned int n);
 void tileVector(std::vector<int64_t> &vals, unsigned int n);
 void tileVector(std::vector<int> &vals, unsigned int n);
 
+std::vector<double> rotateVector(const std::vector<double> &vals, int r);
+
 template <typename T> void print_vector(std::vector<T> vec);
 
 #endif /* OpenFHE_PYTHON_UTILS_H */
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include "openfhe.h"
 
 #include "bgv/BGV_key_operations.hpp"
+#include "bgv/BGV_pickle.hpp"
+#include "bgv/serialization.hpp"
 
 using namespace boost::python;
 using namespace boost::python::numpy;
@@ -24,14 +26,16 @@ namespace pyOpenFHE_BGV {
 // best option is to define these function pointers for different method
 // signatures then pass them later when def'ing the module other option: use
 // lambda function pointers that basically do the same thing but in-line
+void (BGVCryptoContext::*Setup0)() = &BGVCryptoContext::evalBootstrapSetup;
 
-// Minimum number of arguments is 4, maximum is 6 for genBGVContext
-BOOST_PYTHON_FUNCTION_OVERLOADS(BGV_factory_overloads, genBGVContext, 3, 5)
+// Minimum number of arguments is 3, maximum is 11 for genBGVContext
+BOOST_PYTHON_FUNCTION_OVERLOADS(BGV_factory_overloads, genBGVContext, 3, 11)
 
 void export_BGV_CryptoContext_boost() {
 
   class_<pyOpenFHE_BGV::BGVCryptoContext>("BGVCryptoContext",
                                           init<CryptoContext<DCRTPoly>>())
+      .def(init<>()) // for pickle
       .def("enable", &BGVCryptoContext::enable)
       .def("keyGen", &BGVCryptoContext::keyGen)
       .def("evalMultKeyGen", &BGVCryptoContext::evalMultKeyGen)
@@ -49,7 +53,11 @@ void export_BGV_CryptoContext_boost() {
       .def("evalAtIndexKeyGen", &BGVCryptoContext::evalAtIndexKeyGen2)
       .def("evalPowerOf2RotationKeyGen",
            &BGVCryptoContext::evalPowerOf2RotationKeyGen)
-      .def("evalBootstrapSetup", &BGVCryptoContext::evalBootstrapSetup)
+      .def("evalBootstrapSetup", Setup0)
+      .def("evalBootstrapSetup", &BGVCryptoContext::evalBootstrapSetupList,
+           (arg("self"), arg("levelBudget")))
+      .def("evalBootstrapSetup", &BGVCryptoContext::evalBootstrapSetupList2,
+           (arg("self"), arg("levelBudget"), arg("bsgsDim")))
       .def("evalBootstrapKeyGen", &BGVCryptoContext::evalBootstrapKeyGen)
       .def("evalBootstrap", &BGVCryptoContext::evalBootstrap)
       .def("evalBootstrap", &BGVCryptoContext::evalBootstrapList)
@@ -57,19 +65,31 @@ void export_BGV_CryptoContext_boost() {
       .def("encrypt", &BGVCryptoContext::encryptPrivate)
       .def("encrypt", &BGVCryptoContext::encryptPublic2)
       .def("encrypt", &BGVCryptoContext::encryptPrivate2)
+      .def("encryptSeeded", EncryptSeeded_CryptoContext,
+           (arg("self"), arg("privateKey"), arg("values")))
+      .def("encryptSeeded", EncryptSeeded2_CryptoContext,
+           (arg("self"), arg("privateKey"), arg("values")))
       .def("decrypt", &BGVCryptoContext::decrypt)
       .def("getRingDimension", &BGVCryptoContext::getRingDimension)
       .def("getBatchSize", &BGVCryptoContext::getBatchSize)
       .def("getPlaintextModulus", &BGVCryptoContext::getPlaintextModulus)
 
       .def("zeroPadToBatchSize", &BGVCryptoContext::zeroPadToBatchSizeList)
-      .def("zeroPadToBatchSize", &BGVCryptoContext::zeroPadToBatchSizeNumpy);
+      .def("zeroPadToBatchSize", &BGVCryptoContext::zeroPadToBatchSizeNumpy)
+      .def_pickle(BGVCryptoContext_pickle_suite());
 
   def("genCryptoContextBGV", &genBGVContext,
       BGV_factory_overloads((arg("multiplicativeDepth"), arg("batchSize"),
                              arg("plaintextModulus"),
                              arg("stdLevel") = SecurityLevel::HEStd_128_classic,
-                             arg("ringDim") = 0)));
+                             arg("ringDim") = 0,
+                             arg("scalingTechnique") =
+                                 ScalingTechnique::INVALID_RS_TECHNIQUE,
+                             arg("keySwitchTechnique") =
+                                 KeySwitchTechnique::INVALID_KS_TECH,
+                             arg("secretKeyDist") = SecretKeyDist::UNIFORM_TERNARY,
+                             arg("firstModSize") = 0, arg("numLargeDigits") = 0,
+                             arg("maxRelinSkDeg") = 0)));
 }
 
 } // namespace pyOpenFHE_BGV
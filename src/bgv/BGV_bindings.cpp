@@ -99,7 +99,10 @@ void export_BGV_Ciphertext_boost() {
 
       // attempt to support pickling
       .def_pickle(BGVCiphertext_pickle_suite())
+      .def("__reduce_ex__", &BGVCiphertext_pickle_suite::reduce_ex)
       .attr("__module__") = "pyOpenFHE.BGV";
+
+  def("sum", &pyOpenFHE_BGV::BGVSum);
 }
 
 } // namespace pyOpenFHE_BGV
@@ -14,6 +14,7 @@
 
 #include "bgv/BGV_ciphertext_extension.hpp"
 #include "bgv/BGV_key_operations.hpp"
+#include "utils/reduce.hpp"
 #include "utils/rotate_utils.hpp"
 #include "utils/utils.hpp"
 
@@ -191,6 +192,19 @@ boost::python::list BGVHoistedRotations(const BGVCiphertext &ctxt,
   return result;
 }
 
+// parallel tree sum of a python list of ciphertexts, log-depth in len(pylist)
+BGVCiphertext BGVSum(const boost::python::list &pylist) {
+  int num_ctxts = len(pylist);
+  if (num_ctxts == 0) {
+    throw std::runtime_error("Cannot sum an empty list of ciphertexts");
+  }
+  std::vector<BGVCiphertext> ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    ctxts[i] = boost::python::extract<BGVCiphertext>(pylist[i]);
+  }
+  return pyOpenFHE::parallelTreeSum(ctxts);
+}
+
 BGVCiphertext operator>>=(BGVCiphertext &ctxt, int r) { return ctxt <<= (-r); }
 
 BGVCiphertext operator<<(BGVCiphertext ctxt, int r) { return ctxt <<= r; }
@@ -25,13 +25,32 @@ namespace pyOpenFHE_BGV {
 
 BGVCryptoContext genBGVContext(usint multiplicativeDepth, usint batchSize,
                                usint plaintextModulus, SecurityLevel stdLevel,
-                               usint ringDim) {
+                               usint ringDim, ScalingTechnique scalingTechnique,
+                               KeySwitchTechnique keySwitchTechnique,
+                               SecretKeyDist secretKeyDist, usint firstModSize,
+                               usint numLargeDigits, usint maxRelinSkDeg) {
   CCParams<CryptoContextBGVRNS> parameters;
   parameters.SetMultiplicativeDepth(multiplicativeDepth);
   parameters.SetBatchSize(batchSize);
   parameters.SetPlaintextModulus(plaintextModulus);
   parameters.SetSecurityLevel(stdLevel);
   parameters.SetRingDim(ringDim);
+  if (scalingTechnique != INVALID_RS_TECHNIQUE) {
+    parameters.SetScalingTechnique(scalingTechnique);
+  }
+  if (keySwitchTechnique != INVALID_KS_TECH) {
+    parameters.SetKeySwitchTechnique(keySwitchTechnique);
+  }
+  parameters.SetSecretKeyDist(secretKeyDist);
+  if (firstModSize != 0) {
+    parameters.SetFirstModSize(firstModSize);
+  }
+  if (numLargeDigits != 0) {
+    parameters.SetNumLargeDigits(numLargeDigits);
+  }
+  if (maxRelinSkDeg != 0) {
+    parameters.SetMaxRelinSkDeg(maxRelinSkDeg);
+  }
 
   // trying this out, this may fix ModRescale
   // parameters.SetScalingTechnique(FIXEDMANUAL);
@@ -154,13 +173,29 @@ ndarray BGVCryptoContext::decrypt(const PrivateKey<DCRTPoly> &privateKey,
 BGV Bootstrapping functions
 */
 void BGVCryptoContext::evalBootstrapSetup() {
-  std::vector<uint32_t> bsgsDim = {0, 0};
-  std::vector<uint32_t> levelBudget = {4, 4};
+  evalBootstrapSetup({4, 4}, {0, 0});
+}
 
+void BGVCryptoContext::evalBootstrapSetup(
+    const std::vector<uint32_t> &levelBudget,
+    const std::vector<uint32_t> &bsgsDim) {
   usint slots = context->GetEncodingParams()->GetBatchSize();
   context->EvalBootstrapSetup(levelBudget, bsgsDim, slots);
 }
 
+void BGVCryptoContext::evalBootstrapSetupList(const object &levelBudget) {
+  evalBootstrapSetup(
+      pyOpenFHE::pythonListToBootstrapPair(levelBudget, "levelBudget", 1),
+      {0, 0});
+}
+
+void BGVCryptoContext::evalBootstrapSetupList2(const object &levelBudget,
+                                                const object &bsgsDim) {
+  evalBootstrapSetup(
+      pyOpenFHE::pythonListToBootstrapPair(levelBudget, "levelBudget", 1),
+      pyOpenFHE::pythonListToBootstrapPair(bsgsDim, "bsgsDim", 0));
+}
+
 void BGVCryptoContext::evalBootstrapKeyGen(
     const PrivateKey<DCRTPoly> &privateKey) {
   usint slots = context->GetEncodingParams()->GetBatchSize();
@@ -16,6 +16,7 @@ crypto context, and keys here
 #include "bgv/BGV_pickle.hpp"
 #include "bgv/serialization.hpp"
 #include "utils/enums_binding.hpp"
+#include "utils/mmap.hpp"
 #include "utils/utils.hpp"
 
 // header files needed for serialization
@@ -34,17 +35,83 @@ BGVCiphertext_pickle_suite::getinitargs(const pyOpenFHE_BGV::BGVCiphertext &w) {
   return boost::python::make_tuple();
 }
 
+// (version, binary bytes), or a 1-tuple of JSON bytes from before there was a version
+const int ciphertext_pickle_version = 1;
+
+boost::python::object
+binaryCiphertextState(const pyOpenFHE_BGV::BGVCiphertext &w) {
+  PyObject *py_buffer =
+      SerializeToBytes_Ciphertext(w, pyOpenFHE_BGV::SerType::BINARY);
+  boost::python::handle<> handle(py_buffer);
+  return boost::python::object(handle);
+}
+
 boost::python::tuple
 BGVCiphertext_pickle_suite::getstate(const pyOpenFHE_BGV::BGVCiphertext &w) {
+  return boost::python::make_tuple(ciphertext_pickle_version,
+                                   binaryCiphertextState(w));
+}
+
+void BGVCiphertext_pickle_suite::setstate(pyOpenFHE_BGV::BGVCiphertext &w,
+                                          boost::python::tuple state) {
+  using namespace boost::python;
+  if (len(state) == 1) {
+    auto ctxt =
+        DeserializeFromBytes_Ciphertext(state[0], pyOpenFHE_BGV::SerType::JSON);
+    w.cipher = ctxt.cipher;
+    return;
+  }
+
+  if (len(state) != 2 ||
+      extract<int>(state[0]) != ciphertext_pickle_version) {
+    PyErr_SetObject(
+        PyExc_ValueError,
+        ("expected (version, bytes) tuple in call to __setstate__; got %s" %
+         state)
+            .ptr());
+    throw_error_already_set();
+  }
+
+  // may be a protocol 5 out of band buffer. the GIL stays held,
+  // deserializing registers the context in CryptoContextFactory
+  pyOpenFHE::ScopedBuffer buffer(state[1]);
+  Ciphertext<DCRTPoly> obj;
+  pyOpenFHE::MemoryIStream is(buffer.data(), buffer.size());
+  Serial::Deserialize(obj, is, lbcrypto::SerType::BINARY);
+  w.cipher = obj;
+}
+
+// like the CKKS one, hands the payload over as a PickleBuffer from protocol 5 on
+boost::python::object
+BGVCiphertext_pickle_suite::reduce_ex(boost::python::object self,
+                                      int protocol) {
+  using namespace boost::python;
+  const pyOpenFHE_BGV::BGVCiphertext &w =
+      extract<const pyOpenFHE_BGV::BGVCiphertext &>(self);
+  object payload = binaryCiphertextState(w);
+  if (protocol >= 5) {
+    payload = object(handle<>(PyPickleBuffer_FromObject(payload.ptr())));
+  }
+  return make_tuple(self.attr("__class__"), make_tuple(),
+                    make_tuple(ciphertext_pickle_version, payload));
+}
+
+boost::python::tuple BGVCryptoContext_pickle_suite::getinitargs(
+    const pyOpenFHE_BGV::BGVCryptoContext &w) {
+  return boost::python::make_tuple();
+}
+
+boost::python::tuple BGVCryptoContext_pickle_suite::getstate(
+    const pyOpenFHE_BGV::BGVCryptoContext &w) {
   PyObject *py_buffer =
-      SerializeToBytes_Ciphertext(w, pyOpenFHE_BGV::SerType::JSON);
+      SerializeToBytes_CryptoContext(w, pyOpenFHE_BGV::SerType::BINARY);
   boost::python::handle<> handle(py_buffer);
   auto object = boost::python::object(handle);
   return boost::python::make_tuple(object);
 }
 
-void BGVCiphertext_pickle_suite::setstate(pyOpenFHE_BGV::BGVCiphertext &w,
-                                          boost::python::tuple state) {
+void BGVCryptoContext_pickle_suite::setstate(
+    pyOpenFHE_BGV::BGVCryptoContext &w, boost::python::tuple state) {
   using namespace boost::python;
   if (len(state) != 1) {
     PyErr_SetObject(
@@ -54,9 +121,9 @@ void BGVCiphertext_pickle_suite::setstate(pyOpenFHE_BGV::BGVCiphertext &w,
     throw_error_already_set();
   }
 
-  auto ctxt =
-      DeserializeFromBytes_Ciphertext(state[0], pyOpenFHE_BGV::SerType::JSON);
-  w.cipher = ctxt.cipher;
+  auto cc = DeserializeFromBytes_CryptoContext(state[0],
+                                               pyOpenFHE_BGV::SerType::BINARY);
+  w.context = cc.context;
 }
 
 } // namespace pyOpenFHE_BGV
\ No newline at end of file
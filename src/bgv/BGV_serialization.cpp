@@ -5,15 +5,27 @@ define all the serialization functions which operate on our wrapped ciphertext,
 crypto context, and keys here
 */
 
+#include <algorithm>
+#include <fstream>
+#include <set>
 #include <stdexcept>
 
+// string formatting for exceptions
+#include <fmt/format.h>
+
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
 
 #include "bgv/BGV_ciphertext_extension.hpp"
 #include "bgv/BGV_key_operations.hpp"
 #include "bgv/serialization.hpp"
+#include "utils/bundle.hpp"
+#include "utils/bytes_stream.hpp"
+#include "utils/container.hpp"
 #include "utils/enums_binding.hpp"
+#include "utils/eval_keys.hpp"
+#include "utils/mmap.hpp"
+#include "utils/seeded.hpp"
 #include "utils/utils.hpp"
 
 // header files needed for serialization
@@ -29,7 +41,7 @@ namespace pyOpenFHE_BGV {
 
 PyObject *SerializeToBytes_Ciphertext(const pyOpenFHE_BGV::BGVCiphertext &obj,
                                       const pyOpenFHE_BGV::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     Serial::Serialize(obj.cipher, ss, lbcrypto::SerType::BINARY);
@@ -37,25 +49,14 @@ PyObject *SerializeToBytes_Ciphertext(const pyOpenFHE_BGV::BGVCiphertext &obj,
     Serial::Serialize(obj.cipher, ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 pyOpenFHE_BGV::BGVCiphertext
 DeserializeFromBytes_Ciphertext(boost::python::object py_buffer,
                                 const pyOpenFHE_BGV::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   Ciphertext<DCRTPoly> obj;
 
@@ -70,7 +71,7 @@ DeserializeFromBytes_Ciphertext(boost::python::object py_buffer,
 
 PyObject *SerializeToBytes_PublicKey(const PublicKey<DCRTPoly> &obj,
                                      const pyOpenFHE_BGV::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     Serial::Serialize(obj, ss, lbcrypto::SerType::BINARY);
@@ -78,25 +79,14 @@ PyObject *SerializeToBytes_PublicKey(const PublicKey<DCRTPoly> &obj,
     Serial::Serialize(obj, ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 PublicKey<DCRTPoly>
 DeserializeFromBytes_PublicKey(boost::python::object py_buffer,
                                const pyOpenFHE_BGV::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   PublicKey<DCRTPoly> obj;
 
@@ -111,7 +101,7 @@ DeserializeFromBytes_PublicKey(boost::python::object py_buffer,
 
 PyObject *SerializeToBytes_PrivateKey(const PrivateKey<DCRTPoly> &obj,
                                       const pyOpenFHE_BGV::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     Serial::Serialize(obj, ss, lbcrypto::SerType::BINARY);
@@ -119,27 +109,92 @@ PyObject *SerializeToBytes_PrivateKey(const PrivateKey<DCRTPoly> &obj,
     Serial::Serialize(obj, ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 PrivateKey<DCRTPoly>
 DeserializeFromBytes_PrivateKey(boost::python::object py_buffer,
                                 const pyOpenFHE_BGV::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
+
+  PrivateKey<DCRTPoly> obj;
+
+  if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
+    Serial::Deserialize(obj, ss, lbcrypto::SerType::BINARY);
+  } else if (sertype == pyOpenFHE_BGV::SerType::JSON) {
+    Serial::Deserialize(obj, ss, lbcrypto::SerType::JSON);
+  }
+
+  return obj;
+}
+
+// like SerializeToBytes, but into a reusable writable buffer, see the CKKS version
+template <typename T>
+size_t serializeIntoBuffer(const T &obj, const boost::python::object &buffer,
+                           const pyOpenFHE_BGV::SerType sertype) {
+  return pyOpenFHE::serializeInto(buffer, [&](std::ostream &os) {
+    if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
+      Serial::Serialize(obj, os, lbcrypto::SerType::BINARY);
+    } else if (sertype == pyOpenFHE_BGV::SerType::JSON) {
+      Serial::Serialize(obj, os, lbcrypto::SerType::JSON);
+    }
+  });
+}
+
+size_t SerializeInto_Ciphertext(const pyOpenFHE_BGV::BGVCiphertext &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_BGV::SerType sertype) {
+  return serializeIntoBuffer(obj.cipher, buffer, sertype);
+}
+
+size_t SerializeInto_PublicKey(const PublicKey<DCRTPoly> &obj,
+                               const boost::python::object &buffer,
+                               const pyOpenFHE_BGV::SerType sertype) {
+  return serializeIntoBuffer(obj, buffer, sertype);
+}
+
+size_t SerializeInto_PrivateKey(const PrivateKey<DCRTPoly> &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_BGV::SerType sertype) {
+  return serializeIntoBuffer(obj, buffer, sertype);
+}
+
+// see the CKKS version, deserialized contexts are shared through the factory
+BGVCryptoContext checkedContext(const CryptoContext<DCRTPoly> &cc,
+                                const std::string &source) {
+  if (!cc) {
+    throw std::runtime_error("Could not deserialize a CryptoContext from " +
+                             source);
+  }
+  if (cc->getSchemeId() != BGVRNS_SCHEME) {
     throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
+        fmt::format("Deserialized CryptoContext from {} is not a BGV context",
+                    source));
   }
+  return BGVCryptoContext(cc);
+}
 
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+PyObject *SerializeToBytes_CryptoContext(const BGVCryptoContext &obj,
+                                         const pyOpenFHE_BGV::SerType sertype) {
+  pyOpenFHE::BytesOStream ss;
 
-  PrivateKey<DCRTPoly> obj;
+  if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
+    Serial::Serialize(obj.context, ss, lbcrypto::SerType::BINARY);
+  } else if (sertype == pyOpenFHE_BGV::SerType::JSON) {
+    Serial::Serialize(obj.context, ss, lbcrypto::SerType::JSON);
+  }
+
+  return ss.release();
+}
+
+BGVCryptoContext
+DeserializeFromBytes_CryptoContext(boost::python::object py_buffer,
+                                   const pyOpenFHE_BGV::SerType sertype) {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
+
+  CryptoContext<DCRTPoly> obj;
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     Serial::Deserialize(obj, ss, lbcrypto::SerType::BINARY);
@@ -147,12 +202,12 @@ DeserializeFromBytes_PrivateKey(boost::python::object py_buffer,
     Serial::Deserialize(obj, ss, lbcrypto::SerType::JSON);
   }
 
-  return obj;
+  return checkedContext(obj, "bytes");
 }
 
 PyObject *SerializeToBytes_EvalMultKey_CryptoContext(
     BGVCryptoContext &self, const pyOpenFHE_BGV::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     self.context->SerializeEvalMultKey(ss, lbcrypto::SerType::BINARY);
@@ -160,25 +215,14 @@ PyObject *SerializeToBytes_EvalMultKey_CryptoContext(
     self.context->SerializeEvalMultKey(ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 bool DeserializeFromBytes_EvalMultKey_CryptoContext(
     BGVCryptoContext &self, boost::python::object py_buffer,
     const pyOpenFHE_BGV::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     self.context->DeserializeEvalMultKey(ss, lbcrypto::SerType::BINARY);
@@ -191,7 +235,7 @@ bool DeserializeFromBytes_EvalMultKey_CryptoContext(
 
 PyObject *SerializeToBytes_EvalAutomorphismKey_CryptoContext(
     BGVCryptoContext &self, const pyOpenFHE_BGV::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     self.context->SerializeEvalAutomorphismKey(ss, lbcrypto::SerType::BINARY);
@@ -199,25 +243,14 @@ PyObject *SerializeToBytes_EvalAutomorphismKey_CryptoContext(
     self.context->SerializeEvalAutomorphismKey(ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 bool DeserializeFromBytes_EvalAutomorphismKey_CryptoContext(
     BGVCryptoContext &self, boost::python::object py_buffer,
     const pyOpenFHE_BGV::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     self.context->DeserializeEvalAutomorphismKey(ss, lbcrypto::SerType::BINARY);
@@ -247,17 +280,47 @@ bool SerializeToFile_Ciphertext(const std::string &filename,
   return success;
 }
 
+// BGV decryption doesn't depend on magnitudes, and Decrypt compresses to 2 towers
+pyOpenFHE_BGV::BGVCiphertext
+trimForDecryption(const pyOpenFHE_BGV::BGVCiphertext &obj) {
+  if (obj.getTowersRemaining() <= 2) {
+    return obj;
+  }
+  return obj.compress(2);
+}
+
+PyObject *
+SerializeToBytes_TrimmedCiphertext(const pyOpenFHE_BGV::BGVCiphertext &obj,
+                                   const pyOpenFHE_BGV::SerType sertype,
+                                   bool trim) {
+  if (!trim) {
+    return SerializeToBytes_Ciphertext(obj, sertype);
+  }
+  return SerializeToBytes_Ciphertext(trimForDecryption(obj), sertype);
+}
+
+bool SerializeToFile_TrimmedCiphertext(const std::string &filename,
+                                       const pyOpenFHE_BGV::BGVCiphertext &obj,
+                                       const pyOpenFHE_BGV::SerType sertype,
+                                       bool trim) {
+  if (!trim) {
+    return SerializeToFile_Ciphertext(filename, obj, sertype);
+  }
+  return SerializeToFile_Ciphertext(filename, trimForDecryption(obj), sertype);
+}
+
 bool SerializeToFile_CryptoContext(const std::string &filename,
                                    const BGVCryptoContext &obj,
                                    const pyOpenFHE_BGV::SerType sertype) {
-  // throw std::runtime_error("This function is disabled as CryptoContext
-  // Deserialization is broken.");
-
+  // the context itself rather than our wrapper, so it reads back as a
+  // CryptoContext and goes through OpenFHE's context factory
   bool success = false;
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
-    success = Serial::SerializeToFile(filename, obj, lbcrypto::SerType::BINARY);
+    success = Serial::SerializeToFile(filename, obj.context,
+                                      lbcrypto::SerType::BINARY);
   } else if (sertype == pyOpenFHE_BGV::SerType::JSON) {
-    success = Serial::SerializeToFile(filename, obj, lbcrypto::SerType::JSON);
+    success =
+        Serial::SerializeToFile(filename, obj.context, lbcrypto::SerType::JSON);
   }
 
   if (!success) {
@@ -385,26 +448,12 @@ DeserializeFromFile_Ciphertext(const std::string &filename,
   return pyOpenFHE_BGV::BGVCiphertext(obj);
 }
 
-CryptoContext<DCRTPoly>
+BGVCryptoContext
 DeserializeFromFile_CryptoContext(const std::string &filename,
                                   const pyOpenFHE_BGV::SerType sertype) {
-  throw std::runtime_error(
-      "This function is disabled as CryptoContext Deserialization is broken.");
-
-  std::cout << "hello we started the deserialization function" << std::endl;
-
-  lbcrypto::CryptoContextFactory<lbcrypto::DCRTPoly>::ReleaseAllContexts();
-
-  std::cout << "contexts are released" << std::endl;
-
   CryptoContext<DCRTPoly> obj;
   bool success = false;
 
-  std::cout << "new contexts is created" << std::endl;
-
-  // obj->ClearEvalMultKeys();
-  // obj->ClearEvalAutomorphismKeys();
-
   if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
     success =
         Serial::DeserializeFromFile(filename, obj, lbcrypto::SerType::BINARY);
@@ -417,16 +466,7 @@ DeserializeFromFile_CryptoContext(const std::string &filename,
     throw std::runtime_error("Could not read serialized data from file: " +
                              filename);
   }
-
-  std::cout << "deserialization maybe happened" << std::endl;
-
-  auto cc = obj;
-  std::cout << "BGV scheme is using ring dimension = " << cc->GetRingDimension()
-            << std::endl;
-  std::cout << "batch size = " << cc->GetEncodingParams()->GetBatchSize()
-            << std::endl;
-
-  return obj;
+  return checkedContext(obj, filename);
 }
 
 PublicKey<DCRTPoly>
@@ -522,4 +562,462 @@ bool DeserializeFromFile_EvalAutomorphismKey_CryptoContext(
   return success;
 }
 
+bool SerializeToFile_Bundle(const std::string &filename,
+                            BGVCryptoContext &self,
+                            const boost::python::object &py_publicKey,
+                            const boost::python::object &py_privateKey) {
+  PublicKey<DCRTPoly> publicKey;
+  if (!py_publicKey.is_none()) {
+    publicKey = boost::python::extract<PublicKey<DCRTPoly>>(py_publicKey);
+  }
+  PrivateKey<DCRTPoly> privateKey;
+  if (!py_privateKey.is_none()) {
+    privateKey = boost::python::extract<PrivateKey<DCRTPoly>>(py_privateKey);
+  }
+
+  // only this context's keys, copied out while we hold the GIL
+  auto mult_keys = pyOpenFHE::contextEvalMultKeys(self.context);
+  auto automorphism_keys = pyOpenFHE::contextEvalAutomorphismKeys(self.context);
+
+  pyOpenFHE::ScopedGILRelease release;
+
+  using pyOpenFHE::BundleSection;
+  pyOpenFHE::BundleWriter writer(filename, BGVRNS_SCHEME);
+
+  writer.addSection(BundleSection::CONTEXT, [&](std::ostream &os) {
+    Serial::Serialize(self.context, os, lbcrypto::SerType::BINARY);
+  });
+  if (publicKey) {
+    writer.addSection(BundleSection::PUBLIC_KEY, [&](std::ostream &os) {
+      Serial::Serialize(publicKey, os, lbcrypto::SerType::BINARY);
+    });
+  }
+  if (privateKey) {
+    writer.addSection(BundleSection::PRIVATE_KEY, [&](std::ostream &os) {
+      Serial::Serialize(privateKey, os, lbcrypto::SerType::BINARY);
+    });
+  }
+  writer.addSection(BundleSection::EVAL_MULT_KEYS, [&](std::ostream &os) {
+    Serial::Serialize(mult_keys, os, lbcrypto::SerType::BINARY);
+  });
+  writer.addSection(BundleSection::EVAL_AUTOMORPHISM_KEYS,
+                    [&](std::ostream &os) {
+                      Serial::Serialize(automorphism_keys, os,
+                                        lbcrypto::SerType::BINARY);
+                    });
+  writer.finish();
+  return true;
+}
+
+// same as for CKKS, only the sections asked for are parsed, with the GIL held
+boost::python::dict
+DeserializeFromFile_Bundle(const std::string &filename,
+                           const boost::python::object &py_sections) {
+  using pyOpenFHE::BundleSection;
+
+  std::set<BundleSection> wanted;
+  bool everything = py_sections.is_none();
+  if (!everything) {
+    for (int i = 0; i < boost::python::len(py_sections); ++i) {
+      std::string name = boost::python::extract<std::string>(py_sections[i]);
+      wanted.insert(pyOpenFHE::bundleSectionByName(name));
+    }
+  }
+
+  CryptoContext<DCRTPoly> cc;
+  PublicKey<DCRTPoly> publicKey;
+  PrivateKey<DCRTPoly> privateKey;
+
+  pyOpenFHE::BundleReader reader(filename, BGVRNS_SCHEME);
+  auto load = [&](BundleSection section) {
+    return everything ? reader.has(section) : wanted.count(section) > 0;
+  };
+
+  reader.readSection(BundleSection::CONTEXT, [&](std::istream &is) {
+    Serial::Deserialize(cc, is, lbcrypto::SerType::BINARY);
+  });
+  checkedContext(cc, filename);
+
+  if (load(BundleSection::PUBLIC_KEY)) {
+    reader.readSection(BundleSection::PUBLIC_KEY, [&](std::istream &is) {
+      Serial::Deserialize(publicKey, is, lbcrypto::SerType::BINARY);
+    });
+  }
+  if (load(BundleSection::PRIVATE_KEY)) {
+    reader.readSection(BundleSection::PRIVATE_KEY, [&](std::istream &is) {
+      Serial::Deserialize(privateKey, is, lbcrypto::SerType::BINARY);
+    });
+  }
+
+  bool success = true;
+  if (load(BundleSection::EVAL_MULT_KEYS)) {
+    reader.readSection(BundleSection::EVAL_MULT_KEYS, [&](std::istream &is) {
+      success = success &&
+                cc->DeserializeEvalMultKey(is, lbcrypto::SerType::BINARY);
+    });
+  }
+  if (load(BundleSection::EVAL_AUTOMORPHISM_KEYS)) {
+    reader.readSection(
+        BundleSection::EVAL_AUTOMORPHISM_KEYS, [&](std::istream &is) {
+          success = success && cc->DeserializeEvalAutomorphismKey(
+                                   is, lbcrypto::SerType::BINARY);
+        });
+  }
+  if (!success) {
+    throw std::runtime_error("Could not read keys from bundle: " + filename);
+  }
+
+  boost::python::dict result;
+  result["cryptoContext"] = BGVCryptoContext(cc);
+  if (publicKey) {
+    result["publicKey"] = publicKey;
+  }
+  if (privateKey) {
+    result["privateKey"] = privateKey;
+  }
+  return result;
+}
+
+std::vector<Ciphertext<DCRTPoly>>
+extractCiphertexts(const boost::python::list &py_ctxts) {
+  int num_ctxts = boost::python::len(py_ctxts);
+  std::vector<Ciphertext<DCRTPoly>> ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    ctxts[i] =
+        boost::python::extract<pyOpenFHE_BGV::BGVCiphertext>(py_ctxts[i])()
+            .cipher;
+  }
+  return ctxts;
+}
+
+std::vector<std::string>
+serializeCiphertextList(const std::vector<Ciphertext<DCRTPoly>> &ctxts,
+                        const pyOpenFHE_BGV::SerType sertype) {
+  return pyOpenFHE::serializeShards(
+      ctxts.size(), [&](int i, std::ostream &shard) {
+        if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
+          Serial::Serialize(ctxts[i], shard, lbcrypto::SerType::BINARY);
+        } else if (sertype == pyOpenFHE_BGV::SerType::JSON) {
+          Serial::Serialize(ctxts[i], shard, lbcrypto::SerType::JSON);
+        }
+      });
+}
+
+// the first shard registers the context, as in CKKS, then the rest go in parallel
+boost::python::list readCiphertextList(const char *data, size_t size,
+                                       const std::string &source) {
+  pyOpenFHE::ContainerReader reader(data, size, BGVRNS_SCHEME, source);
+  auto sertype = (pyOpenFHE_BGV::SerType)reader.serType();
+  if (sertype != pyOpenFHE_BGV::SerType::BINARY &&
+      sertype != pyOpenFHE_BGV::SerType::JSON) {
+    throw std::runtime_error(fmt::format(
+        "Unknown SerType = {} in ciphertext list container {}",
+        reader.serType(), source));
+  }
+
+  int num_ctxts = reader.count();
+  std::vector<Ciphertext<DCRTPoly>> ctxts(num_ctxts);
+  auto deserialize = [&](int i) {
+    pyOpenFHE::MemoryIStream is(reader.shardData(i), reader.shardSize(i));
+    if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
+      Serial::Deserialize(ctxts[i], is, lbcrypto::SerType::BINARY);
+    } else {
+      Serial::Deserialize(ctxts[i], is, lbcrypto::SerType::JSON);
+    }
+  };
+
+  // registers the context, so this one keeps the GIL
+  if (num_ctxts > 0) {
+    deserialize(0);
+  }
+
+  std::string error;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 1; i < num_ctxts; ++i) {
+      try {
+        deserialize(i);
+      } catch (const std::exception &e) {
+#pragma omp critical
+        if (error.empty()) {
+          error = e.what();
+        }
+      }
+    }
+  }
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+
+  boost::python::list res = pyOpenFHE::make_list(ctxts.size());
+  for (size_t i = 0; i < ctxts.size(); ++i) {
+    res[i] = pyOpenFHE_BGV::BGVCiphertext(ctxts[i]);
+  }
+  return res;
+}
+
+PyObject *SerializeToBytes_CiphertextList(const boost::python::list &py_ctxts,
+                                          const pyOpenFHE_BGV::SerType sertype) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+  std::vector<std::string> shards;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    shards = serializeCiphertextList(ctxts, sertype);
+  }
+  // writing into the bytes object needs the GIL again
+  return pyOpenFHE::serializeToPyBytes([&](std::ostream &os) {
+    pyOpenFHE::writeContainer(os, BGVRNS_SCHEME, (uint32_t)sertype, shards);
+  });
+}
+
+boost::python::list
+DeserializeFromBytes_CiphertextList(boost::python::object py_buffer) {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  return readCiphertextList(buffer.data(), buffer.size(), "bytes");
+}
+
+bool SerializeToFile_CiphertextList(const std::string &filename,
+                                    const boost::python::list &py_ctxts,
+                                    const pyOpenFHE_BGV::SerType sertype) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+
+  std::ofstream file(filename, std::ios::out | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error(
+        "Could not write serialized ciphertext list to file: " + filename);
+  }
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    auto shards = serializeCiphertextList(ctxts, sertype);
+    pyOpenFHE::writeContainer(file, BGVRNS_SCHEME, (uint32_t)sertype, shards);
+  }
+  file.close();
+
+  if (!file) {
+    throw std::runtime_error(
+        "Could not write serialized ciphertext list to file: " + filename);
+  }
+  return true;
+}
+
+boost::python::list
+DeserializeFromFile_CiphertextList(const std::string &filename) {
+  pyOpenFHE::MappedFile file(filename);
+  return readCiphertextList(file.data(), file.size(), filename);
+}
+
+PyObject *encryptSeededPlaintext(BGVCryptoContext &self,
+                                 const PrivateKey<DCRTPoly> &privateKey,
+                                 const Plaintext &ptxt) {
+  auto seed = pyOpenFHE::freshSeed();
+  Ciphertext<DCRTPoly> compact;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    auto ctxt = self.context->Encrypt(privateKey, ptxt);
+    pyOpenFHE::reseedCiphertext(ctxt, privateKey, seed);
+    compact = pyOpenFHE::dropUniform(ctxt);
+  }
+  return pyOpenFHE::serializeToPyBytes([&](std::ostream &os) {
+    pyOpenFHE::writeSeededHeader(os, BGVRNS_SCHEME, seed);
+    Serial::Serialize(compact, os, lbcrypto::SerType::BINARY);
+  });
+}
+
+PyObject *EncryptSeeded_CryptoContext(BGVCryptoContext &self,
+                                      const PrivateKey<DCRTPoly> &privateKey,
+                                      const boost::python::list &pyvals) {
+  auto ptxt = self.encode(pyOpenFHE::pythonListToCppLongIntVector(pyvals));
+  return encryptSeededPlaintext(self, privateKey, ptxt);
+}
+
+PyObject *EncryptSeeded2_CryptoContext(BGVCryptoContext &self,
+                                       const PrivateKey<DCRTPoly> &privateKey,
+                                       const ndarray &pyvals) {
+  auto ptxt = self.encode(pyOpenFHE::numpyListToCppLongIntVector(pyvals));
+  return encryptSeededPlaintext(self, privateKey, ptxt);
+}
+
+pyOpenFHE_BGV::BGVCiphertext
+DeserializeFromBytes_SeededCiphertext(boost::python::object py_buffer) {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  const char *ptr = buffer.data();
+  const char *end = buffer.data() + buffer.size();
+  auto seed = pyOpenFHE::readSeededHeader(ptr, end, BGVRNS_SCHEME, "bytes");
+
+  // deserializing registers the context, only expanding a needs no GIL
+  Ciphertext<DCRTPoly> obj;
+  pyOpenFHE::MemoryIStream is(ptr, end - ptr);
+  Serial::Deserialize(obj, is, lbcrypto::SerType::BINARY);
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    pyOpenFHE::restoreUniform(obj, seed);
+  }
+  return pyOpenFHE_BGV::BGVCiphertext(obj);
+}
+
+pyOpenFHE::RecordDeserializer
+recordDeserializer(uint32_t file_sertype, const std::string &filename) {
+  auto sertype = (pyOpenFHE_BGV::SerType)file_sertype;
+  if (sertype != pyOpenFHE_BGV::SerType::BINARY &&
+      sertype != pyOpenFHE_BGV::SerType::JSON) {
+    throw std::runtime_error(
+        fmt::format("Unknown SerType = {} in ciphertext record file {}",
+                    file_sertype, filename));
+  }
+  return [sertype](const char *data, size_t size) {
+    Ciphertext<DCRTPoly> obj;
+    pyOpenFHE::MemoryIStream is(data, size);
+    if (sertype == pyOpenFHE_BGV::SerType::BINARY) {
+      Serial::Deserialize(obj, is, lbcrypto::SerType::BINARY);
+    } else {
+      Serial::Deserialize(obj, is, lbcrypto::SerType::JSON);
+    }
+    return obj;
+  };
+}
+
+CiphertextWriter::CiphertextWriter(const std::string &filename,
+                                   const pyOpenFHE_BGV::SerType sertype)
+    : sertype(sertype), writer(filename, BGVRNS_SCHEME, (uint32_t)sertype) {}
+
+void CiphertextWriter::write(const pyOpenFHE_BGV::BGVCiphertext &ctxt) {
+  pyOpenFHE::ScopedGILRelease release;
+  std::vector<Ciphertext<DCRTPoly>> ctxts{ctxt.cipher};
+  writer.append(serializeCiphertextList(ctxts, sertype)[0]);
+}
+
+void CiphertextWriter::writeList(const boost::python::list &py_ctxts) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+  pyOpenFHE::ScopedGILRelease release;
+  for (auto &record : serializeCiphertextList(ctxts, sertype)) {
+    writer.append(record);
+  }
+}
+
+void CiphertextWriter::close() {
+  pyOpenFHE::ScopedGILRelease release;
+  writer.close();
+}
+
+CiphertextReader::CiphertextReader(const std::string &filename, int batchSize,
+                                   int prefetch)
+    : reader(filename, BGVRNS_SCHEME),
+      deserialize(recordDeserializer(reader.serType(), filename)),
+      prefetcher(reader, deserialize, batchSize, prefetch) {
+  // the first ciphertext registers the context, with the GIL held and before
+  // any background thread starts, which then only look it up
+  if (reader.count() > 0) {
+    deserialize(reader.recordData(0), reader.recordSize(0));
+  }
+}
+
+pyOpenFHE_BGV::BGVCiphertext CiphertextReader::getItem(long i) const {
+  long count = reader.count();
+  if (i < 0) {
+    i += count;
+  }
+  if (i < 0 || i >= count) {
+    PyErr_SetString(PyExc_IndexError,
+                    "Ciphertext record index out of range");
+    boost::python::throw_error_already_set();
+  }
+
+  std::vector<Ciphertext<DCRTPoly>> ctxts;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    ctxts = pyOpenFHE::readRecords(reader, deserialize, i, 1);
+  }
+  return pyOpenFHE_BGV::BGVCiphertext(ctxts[0]);
+}
+
+boost::python::list CiphertextReader::read(long start, long count) const {
+  if (start < 0 || count < 0) {
+    throw std::runtime_error(fmt::format(
+        "Can't read {} ciphertext records starting at {}", count, start));
+  }
+
+  std::vector<Ciphertext<DCRTPoly>> ctxts;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    reader.willNeed(start, start + count);
+    ctxts = pyOpenFHE::readRecords(reader, deserialize, start, count);
+  }
+
+  boost::python::list py_ctxts;
+  for (auto &ctxt : ctxts) {
+    py_ctxts.append(pyOpenFHE_BGV::BGVCiphertext(ctxt));
+  }
+  return py_ctxts;
+}
+
+void CiphertextReader::restart() {
+  pyOpenFHE::ScopedGILRelease release;
+  prefetcher.restart(0);
+  batch.clear();
+  position = 0;
+}
+
+pyOpenFHE_BGV::BGVCiphertext CiphertextReader::next() {
+  if (position == batch.size()) {
+    pyOpenFHE::ScopedGILRelease release;
+    batch = prefetcher.next();
+    position = 0;
+  }
+  if (batch.empty()) {
+    PyErr_SetNone(PyExc_StopIteration);
+    boost::python::throw_error_already_set();
+  }
+  return pyOpenFHE_BGV::BGVCiphertext(batch[position++]);
+}
+
+boost::python::list CiphertextReader::readBatch() {
+  if (position == batch.size()) {
+    pyOpenFHE::ScopedGILRelease release;
+    batch = prefetcher.next();
+    position = 0;
+  }
+
+  boost::python::list py_ctxts;
+  for (; position < batch.size(); ++position) {
+    py_ctxts.append(pyOpenFHE_BGV::BGVCiphertext(batch[position]));
+  }
+  return py_ctxts;
+}
+
+bool SerializeToFile_CiphertextStore(const std::string &filename,
+                                     const boost::python::list &py_ctxts) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+  pyOpenFHE::ScopedGILRelease release;
+  pyOpenFHE::writeCiphertextStore(filename, BGVRNS_SCHEME, ctxts);
+  return true;
+}
+
+pyOpenFHE_BGV::BGVCiphertext CiphertextHandle::get() const {
+  Ciphertext<DCRTPoly> ctxt;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    ctxt = store->get(index);
+  }
+  return pyOpenFHE_BGV::BGVCiphertext(ctxt);
+}
+
+CiphertextStore::CiphertextStore(const std::string &filename,
+                                 const BGVCryptoContext &cc, int cacheSize)
+    : store(std::make_shared<pyOpenFHE::MappedCiphertextStore>(
+          filename, cc.context, BGVRNS_SCHEME, std::max(cacheSize, 0))) {}
+
+CiphertextHandle CiphertextStore::getItem(long i) const {
+  long count = store->count();
+  if (i < 0) {
+    i += count;
+  }
+  if (i < 0 || i >= count) {
+    PyErr_SetString(PyExc_IndexError, "Ciphertext store index out of range");
+    boost::python::throw_error_already_set();
+  }
+  return CiphertextHandle(store, i);
+}
+
 } // namespace pyOpenFHE_BGV
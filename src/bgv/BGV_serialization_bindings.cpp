@@ -11,6 +11,24 @@
 
 namespace pyOpenFHE_BGV {
 
+BOOST_PYTHON_FUNCTION_OVERLOADS(bundle_save_overloads, SerializeToFile_Bundle,
+                                2, 4)
+BOOST_PYTHON_FUNCTION_OVERLOADS(bundle_load_overloads,
+                                DeserializeFromFile_Bundle, 1, 2)
+
+// the context manager and iterator protocols both hand back the object itself
+object writerEnter(object self) { return self; }
+
+bool writerExit(CiphertextWriter &self, object, object, object) {
+  self.close();
+  return false;
+}
+
+object readerIter(object self) {
+  extract<CiphertextReader &>(self)().restart();
+  return self;
+}
+
 void export_BGV_serialization_boost() {
 
   enum_<pyOpenFHE_BGV::SerType>("SerType")
@@ -23,21 +41,39 @@ void export_BGV_serialization_boost() {
   def("SerializeToBytes", SerializeToBytes_Ciphertext);
   def("SerializeToBytes", SerializeToBytes_PublicKey);
   def("SerializeToBytes", SerializeToBytes_PrivateKey);
+  def("SerializeToBytes", SerializeToBytes_CryptoContext);
+  def("SerializeToBytes", SerializeToBytes_CiphertextList);
+  def("SerializeToBytes", SerializeToBytes_TrimmedCiphertext,
+      (arg("obj"), arg("sertype"), arg("trim")));
+
+  def("SerializeInto", SerializeInto_Ciphertext);
+  def("SerializeInto", SerializeInto_PublicKey);
+  def("SerializeInto", SerializeInto_PrivateKey);
 
   def("SerializeToFile", SerializeToFile_Ciphertext);
   def("SerializeToFile", SerializeToFile_PublicKey);
   def("SerializeToFile", SerializeToFile_PrivateKey);
+  def("SerializeToFile", SerializeToFile_CryptoContext);
+  def("SerializeToFile", SerializeToFile_CiphertextList);
+  def("SerializeToFile", SerializeToFile_TrimmedCiphertext,
+      (arg("filename"), arg("obj"), arg("sertype"), arg("trim")));
 
   def("DeserializeFromBytes_Ciphertext", DeserializeFromBytes_Ciphertext);
   def("DeserializeFromBytes_PublicKey", DeserializeFromBytes_PublicKey);
   def("DeserializeFromBytes_PrivateKey", DeserializeFromBytes_PrivateKey);
+  def("DeserializeFromBytes_CryptoContext",
+      DeserializeFromBytes_CryptoContext);
+  def("DeserializeFromBytes_CiphertextList",
+      DeserializeFromBytes_CiphertextList);
+  def("DeserializeFromBytes_SeededCiphertext",
+      DeserializeFromBytes_SeededCiphertext);
 
   def("DeserializeFromFile_Ciphertext", DeserializeFromFile_Ciphertext);
   def("DeserializeFromFile_PublicKey", DeserializeFromFile_PublicKey);
   def("DeserializeFromFile_PrivateKey", DeserializeFromFile_PrivateKey);
-
-  /* TODO: disabled */
-  def("DeserializeFromFile_CryptoContext", &DeserializeFromFile_CryptoContext);
+  def("DeserializeFromFile_CryptoContext", DeserializeFromFile_CryptoContext);
+  def("DeserializeFromFile_CiphertextList",
+      DeserializeFromFile_CiphertextList);
 
   /*
   The difference is naming between these and the above functions is unfortunate,
@@ -64,6 +100,54 @@ void export_BGV_serialization_boost() {
       &DeserializeFromBytes_EvalMultKey_CryptoContext);
   def("DeserializeFromBytes_EvalAutomorphismKey_CryptoContext",
       &DeserializeFromBytes_EvalAutomorphismKey_CryptoContext);
+
+  def("SerializeToFile_Bundle", SerializeToFile_Bundle,
+      bundle_save_overloads((arg("filename"), arg("cryptoContext"),
+                             arg("publicKey") = object(),
+                             arg("privateKey") = object())));
+  def("DeserializeFromFile_Bundle", DeserializeFromFile_Bundle,
+      bundle_load_overloads((arg("filename"), arg("sections") = object())));
+
+  class_<CiphertextWriter, boost::noncopyable>(
+      "CiphertextWriter",
+      init<std::string, optional<pyOpenFHE_BGV::SerType>>(
+          (arg("filename"), arg("sertype") = pyOpenFHE_BGV::SerType::BINARY)))
+      .def("write", &CiphertextWriter::write)
+      .def("write", &CiphertextWriter::writeList)
+      .def("close", &CiphertextWriter::close)
+      .def("__len__", &CiphertextWriter::len)
+      .def("__enter__", writerEnter)
+      .def("__exit__", writerExit);
+
+  class_<CiphertextReader, boost::noncopyable>(
+      "CiphertextReader",
+      init<std::string, optional<int, int>>(
+          (arg("filename"), arg("batchSize") = 64, arg("prefetch") = 2)))
+      .def("__len__", &CiphertextReader::len)
+      .def("__getitem__", &CiphertextReader::getItem)
+      .def("read", &CiphertextReader::read,
+           (arg("self"), arg("start"), arg("count")))
+      .def("readBatch", &CiphertextReader::readBatch)
+      .def("__iter__", readerIter)
+      .def("__next__", &CiphertextReader::next);
+
+  def("SerializeToFile_CiphertextStore", SerializeToFile_CiphertextStore);
+
+  class_<CiphertextHandle>("CiphertextHandle", no_init)
+      .def("get", &CiphertextHandle::get)
+      .def("isResident", &CiphertextHandle::isResident)
+      .def("getIndex", &CiphertextHandle::getIndex)
+      .def("getTowersRemaining", &CiphertextHandle::getTowersRemaining);
+
+  class_<CiphertextStore, boost::noncopyable>(
+      "CiphertextStore",
+      init<std::string, const BGVCryptoContext &, optional<int>>(
+          (arg("filename"), arg("cryptoContext"), arg("cacheSize") = 64)))
+      .def("__len__", &CiphertextStore::len)
+      .def("__getitem__", &CiphertextStore::getItem)
+      .def("get", &CiphertextStore::get)
+      .def("residentCount", &CiphertextStore::residentCount)
+      .def("clearCache", &CiphertextStore::clearCache);
 }
 
 } // namespace pyOpenFHE_BGV
@@ -8,6 +8,8 @@
 #include "openfhe.h"
 
 #include "ckks/CKKS_key_operations.hpp"
+#include "ckks/CKKS_pickle.hpp"
+#include "ckks/serialization.hpp"
 
 using namespace boost::python;
 using namespace boost::python::numpy;
@@ -25,14 +27,27 @@ namespace pyOpenFHE_CKKS {
 // lambda function pointers that basically do the same thing but in-line
 void (CryptoContextImpl<DCRTPoly>::*Enable1)(PKESchemeFeature) =
     &CryptoContextImpl<DCRTPoly>::Enable;
+void (CKKSCryptoContext::*Setup0)() = &CKKSCryptoContext::evalBootstrapSetup;
 
-// Minimum number of arguments is 3, maximum is 5 for genCKKSContext
-BOOST_PYTHON_FUNCTION_OVERLOADS(CKKS_factory_overloads, genCKKSContext, 3, 5)
+// Minimum number of arguments is 3, maximum is 11 for genCKKSContext
+BOOST_PYTHON_FUNCTION_OVERLOADS(CKKS_factory_overloads, genCKKSContext, 3, 11)
+BOOST_PYTHON_FUNCTION_OVERLOADS(tuneBootstrap_overloads, tuneBootstrap, 3, 4)
+BOOST_PYTHON_FUNCTION_OVERLOADS(tuneParameters_overloads, tuneParameters, 2, 5)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(iterated_overloads,
+                                       CKKSCryptoContext::evalIteratedBootstrap,
+                                       1, 4)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
+    iterated_precision_overloads,
+    CKKSCryptoContext::evalIteratedBootstrapPrecision, 2, 6)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(
+    bootstrap_activation_overloads, CKKSCryptoContext::evalBootstrapActivation,
+    4, 5)
 
 void export_CKKS_CryptoContext_boost() {
 
   class_<pyOpenFHE_CKKS::CKKSCryptoContext>("CKKSCryptoContext",
                                             init<CryptoContext<DCRTPoly>>())
+      .def(init<>()) // for pickle
       .def("enable", &CKKSCryptoContext::enable)
       .def("keyGen", &CKKSCryptoContext::keyGen)
       .def("evalMultKeyGen", &CKKSCryptoContext::evalMultKeyGen)
@@ -50,28 +65,77 @@ void export_CKKS_CryptoContext_boost() {
       .def("evalAtIndexKeyGen", &CKKSCryptoContext::evalAtIndexKeyGen2)
       .def("evalPowerOf2RotationKeyGen",
            &CKKSCryptoContext::evalPowerOf2RotationKeyGen)
-      .def("evalBootstrapSetup", &CKKSCryptoContext::evalBootstrapSetup)
+      .def("evalBootstrapSetup", Setup0)
+      .def("evalBootstrapSetup", &CKKSCryptoContext::evalBootstrapSetupList,
+           (arg("self"), arg("levelBudget")))
+      .def("evalBootstrapSetup", &CKKSCryptoContext::evalBootstrapSetupList2,
+           (arg("self"), arg("levelBudget"), arg("bsgsDim")))
+      .def("evalBootstrapSetup", &CKKSCryptoContext::evalBootstrapSetupSlots,
+           (arg("self"), arg("levelBudget"), arg("bsgsDim"), arg("slots")))
       .def("evalBootstrapKeyGen", &CKKSCryptoContext::evalBootstrapKeyGen)
+      .def("evalBootstrapKeyGen", &CKKSCryptoContext::evalBootstrapKeyGenSlots,
+           (arg("self"), arg("privateKey"), arg("slots")))
       .def("evalBootstrap", &CKKSCryptoContext::evalBootstrap)
       .def("evalBootstrap", &CKKSCryptoContext::evalBootstrapList)
+      .def("evalBootstrap", &CKKSCryptoContext::evalBootstrapSparse,
+           (arg("self"), arg("ctxt"), arg("slots")))
+      .def("evalBootstrap", &CKKSCryptoContext::evalBootstrapSparseList,
+           (arg("self"), arg("ctxts"), arg("slots")))
+      .def("evalBootstrapPacked", &CKKSCryptoContext::evalBootstrapPacked,
+           (arg("self"), arg("ctxts"), arg("slots")))
       .def("evalMetaBootstrap", &CKKSCryptoContext::evalMetaBootstrap)
       .def("evalMetaBootstrap", &CKKSCryptoContext::evalMetaBootstrapList)
+      .def("evalIteratedBootstrap", &CKKSCryptoContext::evalIteratedBootstrap,
+           iterated_overloads((arg("ctxts"), arg("iterations") = 2,
+                               arg("errorScale") = 1e-3,
+                               arg("numThreads") = 0)))
+      .def("evalIteratedBootstrap",
+           &CKKSCryptoContext::evalIteratedBootstrapPrecision,
+           iterated_precision_overloads(
+               (arg("ctxts"), arg("privateKey"), arg("iterations") = 2,
+                arg("errorScale") = 1e-3, arg("targetPrecision") = 0.0,
+                arg("numThreads") = 0)))
+      .def("evalBootstrapActivation",
+           &CKKSCryptoContext::evalBootstrapActivation,
+           bootstrap_activation_overloads(
+               (arg("self"), arg("shards"), arg("fn"), arg("degree"),
+                arg("bound"), arg("cacheKey") = object())))
       .def("encrypt", &CKKSCryptoContext::encryptPublic)
       .def("encrypt", &CKKSCryptoContext::encryptPrivate)
       .def("encrypt", &CKKSCryptoContext::encryptPublic2)
       .def("encrypt", &CKKSCryptoContext::encryptPrivate2)
+      .def("encryptSeeded", EncryptSeeded_CryptoContext,
+           (arg("self"), arg("privateKey"), arg("values")))
+      .def("encryptSeeded", EncryptSeeded2_CryptoContext,
+           (arg("self"), arg("privateKey"), arg("values")))
       .def("decrypt", &CKKSCryptoContext::decrypt)
       .def("getRingDimension", &CKKSCryptoContext::getRingDimension)
       .def("getBatchSize", &CKKSCryptoContext::getBatchSize)
 
       .def("zeroPadToBatchSize", &CKKSCryptoContext::zeroPadToBatchSizeList)
-      .def("zeroPadToBatchSize", &CKKSCryptoContext::zeroPadToBatchSizeNumpy);
+      .def("zeroPadToBatchSize", &CKKSCryptoContext::zeroPadToBatchSizeNumpy)
+      .def_pickle(CKKSCryptoContext_pickle_suite());
 
   def("genCryptoContextCKKS", &genCKKSContext,
       CKKS_factory_overloads(
           (arg("multiplicativeDepth"), arg("scalingFactorBits"),
            arg("batchSize"), arg("stdLevel") = SecurityLevel::HEStd_128_classic,
-           arg("ringDim") = 0)));
+           arg("ringDim") = 0,
+           arg("scalingTechnique") = ScalingTechnique::INVALID_RS_TECHNIQUE,
+           arg("keySwitchTechnique") = KeySwitchTechnique::INVALID_KS_TECH,
+           arg("secretKeyDist") = SecretKeyDist::UNIFORM_TERNARY,
+           arg("firstModSize") = 0, arg("numLargeDigits") = 0,
+           arg("maxRelinSkDeg") = 0)));
+
+  def("tuneBootstrap", &tuneBootstrap,
+      tuneBootstrap_overloads((arg("cc"), arg("sk"), arg("candidates"),
+                               arg("trials") = 3)));
+
+  def("tuneParameters", &tuneParameters,
+      tuneParameters_overloads(
+          (arg("multiplicativeDepth"), arg("precisionBits"),
+           arg("stdLevel") = SecurityLevel::HEStd_128_classic,
+           arg("workload") = object(), arg("trials") = 3)));
 }
 
 } // namespace pyOpenFHE_CKKS
\ No newline at end of file
@@ -15,6 +15,7 @@
 
 #include "ckks/CKKS_ciphertext_extension.hpp"
 #include "ckks/CKKS_pickle.hpp"
+#include "ckks/cnn/poly.hpp"
 #include "utils/utils.hpp"
 
 using namespace boost::python;
@@ -26,6 +27,8 @@ namespace pyOpenFHE_CKKS {
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(CKKS_Rescale_overloads,
                                        pyOpenFHE_CKKS::CKKSCiphertext::Rescale,
                                        0, 1)
+BOOST_PYTHON_FUNCTION_OVERLOADS(activation_overloads,
+                                pyOpenFHE_CKKS::activation, 4, 5)
 
 void export_CKKS_Ciphertext_boost() {
 
@@ -101,7 +104,13 @@ void export_CKKS_Ciphertext_boost() {
       .def(other<ndarray>() * self)
       .def("__array_ufunc__", &pyOpenFHE_CKKS::CKKSCiphertext::array_ufunc)
       .def_pickle(CKKSCiphertext_pickle_suite())
+      .def("__reduce_ex__", &CKKSCiphertext_pickle_suite::reduce_ex)
       .attr("__module__") = "pyOpenFHE.CKKS";
+
+  def("sum", &pyOpenFHE_CKKS::CKKSSum);
+  def("activation", &pyOpenFHE_CKKS::activation,
+      activation_overloads((arg("shards"), arg("fn"), arg("degree"),
+                            arg("bound"), arg("cacheKey") = object())));
 }
 
 } // namespace pyOpenFHE_CKKS
\ No newline at end of file
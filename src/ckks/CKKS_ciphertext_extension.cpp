@@ -14,6 +14,7 @@
 #include "ckks/CKKS_ciphertext_extension.hpp"
 #include "ckks/CKKS_key_operations.hpp"
 #include "utils/exceptions.hpp"
+#include "utils/reduce.hpp"
 #include "utils/rotate_utils.hpp"
 #include "utils/utils.hpp"
 
@@ -156,35 +157,91 @@ CKKSCiphertext operator<<=(CKKSCiphertext &ctxt, int r) {
   return EvalRotatePositiveNegativePow2(ctxt, r);
 }
 
+// true if ctxt's context holds a dedicated key for a rotation by r,
+// i.e. EvalAtIndex / EvalFastRotation by r won't throw
+bool CKKSHasRotationKey(const CKKSCiphertext &ctxt, int r) {
+  auto cc = ctxt.cipher->GetCryptoContext();
+  try {
+    auto &keys = cc->GetEvalAutomorphismKeyMap(ctxt.cipher->GetKeyTag());
+    return keys.find(cc->FindAutomorphismIndex(r)) != keys.end();
+  } catch (...) {
+    // no rotation keys at all for this key tag
+    return false;
+  }
+}
+
 /*
-TODO
-need error checking to see if that rotation key actually exists.
-Also this function should support integer numpy arrays as well
+rotate ctxt by every entry of rotations, sharing one
+EvalFastRotationPrecompute across all of them.
+rotations that don't have a dedicated key fall back to the power-of-2 chain,
+so this still works with only evalPowerOf2RotationKeyGen keys
+(just without the savings for those indices).
 */
-boost::python::list CKKSHoistedRotations(const CKKSCiphertext &ctxt,
-                                         const boost::python::list &pylist) {
-  std::vector<int32_t> rotations = pyOpenFHE::pythonListToCppIntVector(pylist);
+std::vector<CKKSCiphertext>
+CKKSHoistedRotationsVector(const CKKSCiphertext &ctxt,
+                           const std::vector<int> &rotations) {
+  std::vector<bool> has_key(rotations.size());
+  bool any_key = false;
+  for (unsigned int i = 0; i < rotations.size(); i++) {
+    has_key[i] = (rotations[i] != 0) && CKKSHasRotationKey(ctxt, rotations[i]);
+    any_key = any_key || has_key[i];
+  }
 
   auto cc = ctxt.cipher->GetCryptoContext();
-  auto cPrecomp = cc->EvalFastRotationPrecompute(ctxt.cipher);
+
+  // the precompute is a full key-switch decomposition, only pay for it if used
+  std::shared_ptr<std::vector<DCRTPoly>> cPrecomp;
+  if (any_key) {
+    cPrecomp = cc->EvalFastRotationPrecompute(ctxt.cipher);
+  }
 
   // M is the cyclotomic order and we need it to call EvalFastRotation
   uint32_t N = cc->GetRingDimension();
   uint32_t M = 2 * N;
 
-  // initialize list to correct length
-  boost::python::object empty_item = boost::python::object(); // None
-  boost::python::list result;
-  result.append(empty_item);
-  result *= rotations.size();
+  std::vector<CKKSCiphertext> result(rotations.size());
 
+#pragma omp parallel for
   for (unsigned int i = 0; i < rotations.size(); i++) {
-    result[i] = pyOpenFHE_CKKS::CKKSCiphertext(
-        cc->EvalFastRotation(ctxt.cipher, rotations[i], M, cPrecomp));
+    if (has_key[i]) {
+      result[i] = CKKSCiphertext(
+          cc->EvalFastRotation(ctxt.cipher, rotations[i], M, cPrecomp));
+    } else {
+      result[i] = ctxt << rotations[i];
+    }
+  }
+  return result;
+}
+
+/*
+TODO
+this function should support integer numpy arrays as well
+*/
+boost::python::list CKKSHoistedRotations(const CKKSCiphertext &ctxt,
+                                         const boost::python::list &pylist) {
+  std::vector<int32_t> rotations = pyOpenFHE::pythonListToCppIntVector(pylist);
+  auto rotated = CKKSHoistedRotationsVector(ctxt, rotations);
+
+  boost::python::list result = pyOpenFHE::make_list(rotated.size());
+  for (unsigned int i = 0; i < rotated.size(); i++) {
+    result[i] = rotated[i];
   }
   return result;
 }
 
+// parallel tree sum of a python list of ciphertexts, log-depth in len(pylist)
+CKKSCiphertext CKKSSum(const boost::python::list &pylist) {
+  int num_ctxts = len(pylist);
+  if (num_ctxts == 0) {
+    throw std::runtime_error("Cannot sum an empty list of ciphertexts");
+  }
+  std::vector<CKKSCiphertext> ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    ctxts[i] = boost::python::extract<CKKSCiphertext>(pylist[i]);
+  }
+  return pyOpenFHE::parallelTreeSum(ctxts);
+}
+
 CKKSCiphertext operator>>=(CKKSCiphertext &ctxt, double r) {
   return ctxt <<= (-r);
 }
@@ -2,10 +2,22 @@
 
 // encrypt, decrypt, keygeneration, and the like
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <complex>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <vector>
 
+#include <omp.h>
+
 // string formatting for exceptions
 #include <fmt/format.h>
 
@@ -14,9 +26,14 @@
 
 #include "ckks/CKKS_ciphertext_extension.hpp"
 #include "ckks/CKKS_key_operations.hpp"
+#include "ckks/cnn/poly.hpp"
 #include "ckks/serialization.hpp"
+#include "utils/eval_keys.hpp"
 #include "utils/utils.hpp"
 
+// header files needed for serialization
+#include "key/key-ser.h"
+
 using namespace boost::python;
 using namespace boost::python::numpy;
 using namespace lbcrypto;
@@ -24,9 +41,13 @@ using namespace pyOpenFHE;
 
 namespace pyOpenFHE_CKKS {
 
-CKKSCryptoContext genCKKSContext(usint multiplicativeDepth,
-                                 usint scalingFactorBits, usint batchSize,
-                                 SecurityLevel stdLevel, usint ringDim) {
+CKKSCryptoContext
+genCKKSContext(usint multiplicativeDepth, usint scalingFactorBits,
+               usint batchSize, SecurityLevel stdLevel, usint ringDim,
+               ScalingTechnique scalingTechnique,
+               KeySwitchTechnique keySwitchTechnique,
+               SecretKeyDist secretKeyDist, usint firstModSize,
+               usint numLargeDigits, usint maxRelinSkDeg) {
   CCParams<CryptoContextCKKSRNS> parameters;
   parameters.SetMultiplicativeDepth(multiplicativeDepth);
   parameters.SetScalingModSize(scalingFactorBits);
@@ -35,6 +56,22 @@ CKKSCryptoContext genCKKSContext(usint multiplicativeDepth,
   if(ringDim != 0) {
     parameters.SetRingDim(ringDim);
   }
+  if (scalingTechnique != INVALID_RS_TECHNIQUE) {
+    parameters.SetScalingTechnique(scalingTechnique);
+  }
+  if (keySwitchTechnique != INVALID_KS_TECH) {
+    parameters.SetKeySwitchTechnique(keySwitchTechnique);
+  }
+  parameters.SetSecretKeyDist(secretKeyDist);
+  if (firstModSize != 0) {
+    parameters.SetFirstModSize(firstModSize);
+  }
+  if (numLargeDigits != 0) {
+    parameters.SetNumLargeDigits(numLargeDigits);
+  }
+  if (maxRelinSkDeg != 0) {
+    parameters.SetMaxRelinSkDeg(maxRelinSkDeg);
+  }
 
   CryptoContext<DCRTPoly> native_cc = GenCryptoContext(parameters);
   
@@ -136,6 +173,13 @@ ndarray CKKSCryptoContext::zeroPadToBatchSizeNumpy(const ndarray &pyvals) {
 // an error check here...
 ndarray CKKSCryptoContext::decrypt(const PrivateKey<DCRTPoly> &privateKey,
                                    pyOpenFHE_CKKS::CKKSCiphertext &ctxt) {
+  return pyOpenFHE::cppDoubleVectorToNumpyList(decryptValues(privateKey, ctxt));
+}
+
+// decrypt without touching python, so this is safe with the GIL released
+std::vector<double>
+CKKSCryptoContext::decryptValues(const PrivateKey<DCRTPoly> &privateKey,
+                                 const pyOpenFHE_CKKS::CKKSCiphertext &ctxt) {
   Plaintext ptxt;
   // level reduce to level2 before decrypting
   auto algo = ctxt.cipher->GetCryptoContext()->GetScheme();
@@ -147,18 +191,120 @@ ndarray CKKSCryptoContext::decrypt(const PrivateKey<DCRTPoly> &privateKey,
   for (unsigned int i = 0; i < cvals.size(); i++) {
     vals[i] = std::real(cvals[i]);
   }
-  return pyOpenFHE::cppDoubleVectorToNumpyList(vals);
+  return vals;
 }
 
 /*
 CKKS Bootstrapping functions
 */
 void CKKSCryptoContext::evalBootstrapSetup() {
-  std::vector<uint32_t> bsgsDim = {0, 0};
-  std::vector<uint32_t> levelBudget = {4, 4};
+  evalBootstrapSetup({4, 4}, {0, 0});
+}
 
-  usint slots = context->GetEncodingParams()->GetBatchSize();
+void CKKSCryptoContext::evalBootstrapSetup(
+    const std::vector<uint32_t> &levelBudget,
+    const std::vector<uint32_t> &bsgsDim) {
+  evalBootstrapSetup(levelBudget, bsgsDim, getBatchSize());
+}
+
+/*
+OpenFHE keeps the precomputations for every slot count side by side and picks
+one by the ciphertext's slot count, but doesn't let us ask which ones exist.
+So we remember them here, per context, to dispatch sparse bootstraps on
+and to replay when restoring a saved bootstrapping state.
+The CKKSCryptoContext wrappers come and go, so this is keyed by the context itself,
+through a weak_ptr so a freed context's entry can't be picked up by a new one at the same address.
+*/
+std::mutex bootstrap_slots_mutex;
+std::map<std::weak_ptr<CryptoContextImpl<DCRTPoly>>,
+         std::map<uint32_t, BootstrapConfig>,
+         std::owner_less<std::weak_ptr<CryptoContextImpl<DCRTPoly>>>>
+    bootstrap_slots;
+
+void CKKSCryptoContext::evalBootstrapSetup(
+    const std::vector<uint32_t> &levelBudget,
+    const std::vector<uint32_t> &bsgsDim, uint32_t slots) {
   context->EvalBootstrapSetup(levelBudget, bsgsDim, slots);
+
+  std::lock_guard<std::mutex> lock(bootstrap_slots_mutex);
+  for (auto it = bootstrap_slots.begin(); it != bootstrap_slots.end();) {
+    it = it->first.expired() ? bootstrap_slots.erase(it) : std::next(it);
+  }
+  bootstrap_slots[std::weak_ptr<CryptoContextImpl<DCRTPoly>>(context)][slots] =
+      {levelBudget, bsgsDim};
+}
+
+std::map<uint32_t, BootstrapConfig> CKKSCryptoContext::bootstrapConfigs() {
+  std::lock_guard<std::mutex> lock(bootstrap_slots_mutex);
+  auto configured =
+      bootstrap_slots.find(std::weak_ptr<CryptoContextImpl<DCRTPoly>>(context));
+  if (configured == bootstrap_slots.end()) {
+    return {};
+  }
+  return configured->second;
+}
+
+// slots is a single slot count or a list of them, each a power of 2 dividing the batch size
+std::vector<uint32_t> bootstrapSlotCounts(const object &slots, uint32_t batch_size) {
+  std::vector<uint32_t> counts;
+  if (extract<int>(slots).check()) {
+    counts.push_back(extract<int>(slots));
+  } else {
+    for (int i = 0; i < len(slots); ++i) {
+      counts.push_back(extract<int>(slots[i]));
+    }
+  }
+
+  for (uint32_t count : counts) {
+    if (count == 0 || (count & (count - 1)) != 0 || count > batch_size) {
+      throw std::runtime_error(fmt::format(
+          "Bootstrapping slot count = {} must be a power of 2 no larger than "
+          "the batch size = {}",
+          count, batch_size));
+    }
+  }
+  return counts;
+}
+
+void CKKSCryptoContext::evalBootstrapSetupSlots(const object &levelBudget,
+                                                const object &bsgsDim,
+                                                const object &slots) {
+  auto level_budget =
+      pyOpenFHE::pythonListToBootstrapPair(levelBudget, "levelBudget", 1);
+  auto bsgs_dim = pyOpenFHE::pythonListToBootstrapPair(bsgsDim, "bsgsDim", 0);
+  for (uint32_t count : bootstrapSlotCounts(slots, getBatchSize())) {
+    evalBootstrapSetup(level_budget, bsgs_dim, count);
+  }
+}
+
+// the smallest slot count we've been set up for that holds num_slots
+uint32_t CKKSCryptoContext::bootstrapSlotsFor(uint32_t num_slots) {
+  std::lock_guard<std::mutex> lock(bootstrap_slots_mutex);
+  auto configured =
+      bootstrap_slots.find(std::weak_ptr<CryptoContextImpl<DCRTPoly>>(context));
+  if (configured != bootstrap_slots.end()) {
+    auto it = configured->second.lower_bound(num_slots);
+    if (it != configured->second.end()) {
+      return it->first;
+    }
+  }
+  throw std::runtime_error(fmt::format(
+      "No bootstrapping setup holds {} slots, call evalBootstrapSetup with a "
+      "large enough slot count first",
+      num_slots));
+}
+
+void CKKSCryptoContext::evalBootstrapSetupList(const object &levelBudget) {
+  evalBootstrapSetup(
+      pyOpenFHE::pythonListToBootstrapPair(levelBudget, "levelBudget", 1),
+      {0, 0});
+}
+
+void CKKSCryptoContext::evalBootstrapSetupList2(const object &levelBudget,
+                                                const object &bsgsDim) {
+  evalBootstrapSetup(
+      pyOpenFHE::pythonListToBootstrapPair(levelBudget, "levelBudget", 1),
+      pyOpenFHE::pythonListToBootstrapPair(bsgsDim, "bsgsDim", 0));
 }
 
 void CKKSCryptoContext::evalBootstrapKeyGen(
@@ -169,6 +315,177 @@ void CKKSCryptoContext::evalBootstrapKeyGen(
   context->EvalBootstrapKeyGen(privateKey, slots);
 }
 
+void CKKSCryptoContext::evalBootstrapKeyGenSlots(
+    const PrivateKey<DCRTPoly> &privateKey, const object &slots) {
+  for (uint32_t count : bootstrapSlotCounts(slots, getBatchSize())) {
+    context->EvalBootstrapKeyGen(privateKey, count);
+  }
+}
+
+void checkOccupiedSlots(int num_slots, uint32_t batch_size) {
+  if (num_slots < 1 || (uint32_t)num_slots > batch_size) {
+    throw std::runtime_error(
+        fmt::format("Number of occupied slots = {} must be between 1 and the "
+                    "batch size = {}",
+                    num_slots, batch_size));
+  }
+}
+
+// multiplies by 1 in the first num_slots slots and 0 everywhere else
+pyOpenFHE_CKKS::CKKSCiphertext maskLeadingSlots(pyOpenFHE_CKKS::CKKSCiphertext ctxt,
+                                                int num_slots, uint32_t batch_size) {
+  std::vector<double> mask(batch_size, 0.0);
+  std::fill(mask.begin(), mask.begin() + num_slots, 1.0);
+  return ctxt * mask;
+}
+
+/*
+Bootstraps a ciphertext whose values all sit in its first num_slots slots (the rest are zero),
+using the cheapest slot configuration that holds them.
+OpenFHE's sparse bootstrapping expects the values to repeat every `slots` slots,
+so we fill the zeros with copies first. They're still there afterwards.
+*/
+pyOpenFHE_CKKS::CKKSCiphertext
+CKKSCryptoContext::evalBootstrapReplicated(pyOpenFHE_CKKS::CKKSCiphertext ctxt,
+                                           int num_slots) {
+  uint32_t batch_size = getBatchSize();
+  uint32_t slots = bootstrapSlotsFor(num_slots);
+  if (slots == batch_size) {
+    return evalBootstrap(ctxt);
+  }
+
+  // this always runs at least once, so we never call SetSlots on the caller's ciphertext
+  for (uint32_t shift = slots; shift < batch_size; shift *= 2) {
+    ctxt += ctxt << shift;
+  }
+
+  ctxt.cipher->SetSlots(slots);
+  ctxt.cipher = context->EvalBootstrap(ctxt.cipher);
+  ctxt.cipher->SetSlots(batch_size);
+  return ctxt;
+}
+
+// masking the copies back to zero costs one more level than a full bootstrap
+pyOpenFHE_CKKS::CKKSCiphertext
+CKKSCryptoContext::evalBootstrapSparse(pyOpenFHE_CKKS::CKKSCiphertext ctxt,
+                                       int num_slots) {
+  uint32_t batch_size = getBatchSize();
+  checkOccupiedSlots(num_slots, batch_size);
+  if (bootstrapSlotsFor(num_slots) == batch_size) {
+    return evalBootstrap(ctxt);
+  }
+  return maskLeadingSlots(evalBootstrapReplicated(ctxt, num_slots), num_slots, batch_size);
+}
+
+/*
+Bootstraps many ciphertexts whose values all sit in their first num_slots slots
+by packing them into as few ciphertexts as possible, one block of
+next_pow2(num_slots) slots each, bootstrapping those, and unpacking the blocks again.
+Packing is a tree of power-of-2 rotations, unpacking shares one hoisted
+decomposition per packed ciphertext, and the unpacking masks cost one level.
+*/
+boost::python::list CKKSCryptoContext::evalBootstrapPacked(boost::python::list ctxts,
+                                                           int num_slots) {
+  uint32_t batch_size = getBatchSize();
+  checkOccupiedSlots(num_slots, batch_size);
+
+  int block = 1;
+  while (block < num_slots) {
+    block *= 2;
+  }
+  int per_pack = batch_size / block;
+
+  int num_ctxts = len(ctxts);
+  int num_packs = (num_ctxts + per_pack - 1) / per_pack;
+  std::vector<pyOpenFHE_CKKS::CKKSCiphertext> input_ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    input_ctxts[i] = extract<pyOpenFHE_CKKS::CKKSCiphertext>(ctxts[i]);
+  }
+
+  std::string error;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+
+#pragma omp parallel for
+    for (int p = 0; p < num_packs; ++p) {
+      try {
+        int first = p * per_pack;
+        int count = std::min(per_pack, num_ctxts - first);
+
+        // ciphertext k of this pack ends up in block k
+        std::vector<pyOpenFHE_CKKS::CKKSCiphertext> terms(
+            input_ctxts.begin() + first, input_ctxts.begin() + first + count);
+        for (int gap = 1; gap < count; gap *= 2) {
+          for (int k = 0; k + gap < count; k += 2 * gap) {
+            terms[k] += terms[k + gap] >> (gap * block);
+          }
+        }
+
+        auto packed = evalBootstrapReplicated(terms[0], (count - 1) * block + num_slots);
+
+        std::vector<int> rotations(count);
+        for (int k = 0; k < count; ++k) {
+          rotations[k] = k * block;
+        }
+        auto unpacked = CKKSHoistedRotationsVector(packed, rotations);
+        for (int k = 0; k < count; ++k) {
+          input_ctxts[first + k] = maskLeadingSlots(unpacked[k], num_slots, batch_size);
+        }
+      } catch (const std::exception &e) {
+#pragma omp critical
+        if (error.empty()) {
+          error = e.what();
+        }
+      }
+    }
+  }
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+
+  auto output_ctxts = pyOpenFHE::make_list(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    output_ctxts[i] = input_ctxts[i];
+  }
+  return output_ctxts;
+}
+
+boost::python::list CKKSCryptoContext::evalBootstrapSparseList(boost::python::list ctxts,
+                                                               int num_slots) {
+  int num_ctxts = len(ctxts);
+  std::vector<pyOpenFHE_CKKS::CKKSCiphertext> input_ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    input_ctxts[i] = extract<pyOpenFHE_CKKS::CKKSCiphertext>(ctxts[i]);
+  }
+
+  // the first error, since we can't throw from inside the parallel loop
+  std::string error;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+
+#pragma omp parallel for
+    for (int i = 0; i < num_ctxts; ++i) {
+      try {
+        input_ctxts[i] = evalBootstrapSparse(input_ctxts[i], num_slots);
+      } catch (const std::exception &e) {
+#pragma omp critical
+        if (error.empty()) {
+          error = e.what();
+        }
+      }
+    }
+  }
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+
+  auto output_ctxts = pyOpenFHE::make_list(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    output_ctxts[i] = input_ctxts[i];
+  }
+  return output_ctxts;
+}
+
 boost::python::list CKKSCryptoContext::evalBootstrapList(boost::python::list ctxts) {
 
   std::vector<pyOpenFHE_CKKS::CKKSCiphertext> input_ctxts(len(ctxts));
@@ -184,33 +501,163 @@ boost::python::list CKKSCryptoContext::evalBootstrapList(boost::python::list ctx
   return output_ctxts;
 }
 
-pyOpenFHE_CKKS::CKKSCiphertext CKKSCryptoContext::evalMetaBootstrap(pyOpenFHE_CKKS::CKKSCiphertext ctxt) {
-    double error_scale = 1e-3;
-    auto c2 = pyOpenFHE_CKKS::CKKSCiphertext(context->EvalBootstrap(ctxt.cipher));
-    auto e1 = (ctxt - c2) * (1/error_scale);
-    auto e2 = pyOpenFHE_CKKS::CKKSCiphertext(context->EvalBootstrap(e1.cipher)) * error_scale;
-    auto c3 = c2 + e2;
-    return c3;
+// bits of precision of a result whose largest error in any slot is max_error,
+// an exact result gets the 52 bits of a double rather than inf
+double bitsOfPrecision(double max_error) {
+  return -std::log2(
+      std::max(max_error, std::numeric_limits<double>::epsilon()));
 }
 
-boost::python::list CKKSCryptoContext::evalMetaBootstrapList(boost::python::list ctxts) {
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> input_ctxts(len(ctxts));
-    auto output_ctxts = pyOpenFHE::make_list(len(ctxts));
+/*
+Iterated (meta) bootstrapping: after bootstrapping c = BT(x), each further iteration
+bootstraps the residual (x - c) / s^k and adds it back scaled by s^k,
+where s = errorScale should be about the relative error of a single bootstrap,
+so the residual is about as big as x was.
+Stages run in parallel across ciphertexts on up to numThreads threads (0 for OpenMP's default).
 
-    for(int i = 0; i < len(ctxts); ++i) {
-        input_ctxts[i] = extract<pyOpenFHE_CKKS::CKKSCiphertext>(ctxts[i]);
-    }
+With a privateKey, the precision in bits of every ciphertext after every iteration is
+appended to precisions, measured against the decrypted input,
+and ciphertexts already at targetPrecision bits (if positive) skip the remaining iterations.
+This doesn't touch python, the callers release the GIL around it.
+*/
+void CKKSCryptoContext::iteratedBootstrap(
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &ctxts, int iterations,
+    double errorScale, int numThreads, const PrivateKey<DCRTPoly> &privateKey,
+    double targetPrecision, std::vector<std::vector<double>> &precisions) {
+  if (iterations < 1) {
+    throw std::runtime_error(fmt::format(
+        "Number of bootstrapping iterations = {} must be at least 1",
+        iterations));
+  }
+  if (errorScale <= 0.0 || errorScale >= 1.0) {
+    throw std::runtime_error(fmt::format(
+        "Meta-bootstrapping errorScale = {} must be strictly between 0 and 1",
+        errorScale));
+  }
+
+  int num_ctxts = ctxts.size();
+  int num_threads = numThreads > 0 ? numThreads : omp_get_max_threads();
+  std::vector<pyOpenFHE_CKKS::CKKSCiphertext> inputs = ctxts;
 
-    #pragma omp parallel for
-    for(int i = 0; i < len(ctxts); ++i) {
-        input_ctxts[i] = evalMetaBootstrap(input_ctxts[i]);
+  std::vector<std::vector<double>> reference(num_ctxts);
+  precisions.assign(num_ctxts, {});
+  std::vector<char> active(num_ctxts, 1);
+  std::string error;
+
+  if (privateKey) {
+#pragma omp parallel for num_threads(num_threads)
+    for (int i = 0; i < num_ctxts; ++i) {
+      reference[i] = decryptValues(privateKey, inputs[i]);
     }
+  }
 
-    for(int i = 0; i < len(ctxts); ++i) {
-        output_ctxts[i] = input_ctxts[i];
+  double scale = 1.0;
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (int i = 0; i < num_ctxts; ++i) {
+      if (!active[i]) {
+        continue;
+      }
+      try {
+        if (iteration == 0) {
+          ctxts[i].cipher = context->EvalBootstrap(inputs[i].cipher);
+        } else {
+          auto residual = (inputs[i] - ctxts[i]) * (1 / scale);
+          ctxts[i] += pyOpenFHE_CKKS::CKKSCiphertext(
+                          context->EvalBootstrap(residual.cipher)) *
+                      scale;
+        }
+
+        if (privateKey) {
+          auto values = decryptValues(privateKey, ctxts[i]);
+          double max_error = 0.0;
+          for (size_t j = 0; j < values.size(); ++j) {
+            max_error = std::max(max_error, std::abs(values[j] - reference[i][j]));
+          }
+          double bits = bitsOfPrecision(max_error);
+          precisions[i].push_back(bits);
+          if (targetPrecision > 0 && bits >= targetPrecision) {
+            active[i] = 0;
+          }
+        }
+      } catch (const std::exception &e) {
+#pragma omp critical
+        if (error.empty()) {
+          error = e.what();
+        }
+        active[i] = 0;
+      }
     }
-    
-    return output_ctxts;
+    scale *= errorScale;
+  }
+
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+}
+
+pyOpenFHE_CKKS::CKKSCiphertext CKKSCryptoContext::evalMetaBootstrap(pyOpenFHE_CKKS::CKKSCiphertext ctxt) {
+  std::vector<pyOpenFHE_CKKS::CKKSCiphertext> ctxts = {ctxt};
+  std::vector<std::vector<double>> precisions;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    iteratedBootstrap(ctxts, 2, 1e-3, 0, nullptr, 0.0, precisions);
+  }
+  return ctxts[0];
+}
+
+boost::python::list CKKSCryptoContext::evalMetaBootstrapList(boost::python::list ctxts) {
+  return evalIteratedBootstrap(ctxts, 2, 1e-3, 0);
+}
+
+boost::python::list CKKSCryptoContext::evalIteratedBootstrap(
+    const boost::python::list &ctxts, int iterations, double errorScale,
+    int numThreads) {
+  int num_ctxts = len(ctxts);
+  std::vector<pyOpenFHE_CKKS::CKKSCiphertext> input_ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    input_ctxts[i] = extract<pyOpenFHE_CKKS::CKKSCiphertext>(ctxts[i]);
+  }
+
+  std::vector<std::vector<double>> precisions;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    iteratedBootstrap(input_ctxts, iterations, errorScale, numThreads, nullptr,
+                      0.0, precisions);
+  }
+
+  auto output_ctxts = pyOpenFHE::make_list(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    output_ctxts[i] = input_ctxts[i];
+  }
+  return output_ctxts;
+}
+
+// returns (ctxts, precisions), where precisions[i] lists the bits of precision of ctxts[i] after each iteration it ran
+tuple CKKSCryptoContext::evalIteratedBootstrapPrecision(
+    const boost::python::list &ctxts, const PrivateKey<DCRTPoly> &privateKey,
+    int iterations, double errorScale, double targetPrecision,
+    int numThreads) {
+  int num_ctxts = len(ctxts);
+  std::vector<pyOpenFHE_CKKS::CKKSCiphertext> input_ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    input_ctxts[i] = extract<pyOpenFHE_CKKS::CKKSCiphertext>(ctxts[i]);
+  }
+
+  std::vector<std::vector<double>> precisions;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    iteratedBootstrap(input_ctxts, iterations, errorScale, numThreads,
+                      privateKey, targetPrecision, precisions);
+  }
+
+  auto output_ctxts = pyOpenFHE::make_list(num_ctxts);
+  boost::python::list output_precisions;
+  for (int i = 0; i < num_ctxts; ++i) {
+    output_ctxts[i] = input_ctxts[i];
+    output_precisions.append(pyOpenFHE::cppVectorToPythonList(precisions[i]));
+  }
+  return boost::python::make_tuple(output_ctxts, output_precisions);
 }
 
 pyOpenFHE_CKKS::CKKSCiphertext
@@ -219,6 +666,559 @@ CKKSCryptoContext::evalBootstrap(pyOpenFHE_CKKS::CKKSCiphertext ctxt) {
   return ctxt;
 }
 
+/*
+Bootstraps every shard and evaluates the activation on it (see activation in
+cnn/poly.cpp for fn, degree and bound) in one pass, so each thread goes straight
+from its bootstrap into the Chebyshev series without a round trip through python.
+Returns (shards, levels), where levels is the multiplicative depth left afterwards.
+*/
+tuple CKKSCryptoContext::evalBootstrapActivation(const list &ctxts,
+                                                 const object &fn, int degree,
+                                                 double bound,
+                                                 const object &cacheKey) {
+  int num_ctxts = len(ctxts);
+  if (num_ctxts == 0) {
+    throw std::runtime_error("Cannot bootstrap an empty list of ciphertexts");
+  }
+
+  std::vector<pyOpenFHE_CKKS::CKKSCiphertext> shards(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    shards[i] = extract<pyOpenFHE_CKKS::CKKSCiphertext>(ctxts[i]);
+  }
+
+  // may call back into python, so this has to happen before releasing the GIL
+  auto coefficients =
+      pyOpenFHE_CKKS::activationCoefficients(fn, degree, -bound, bound,
+                                             cacheKey);
+  int depth =
+      pyOpenFHE_CKKS::chebyshevSeriesDepth(coefficients, -bound, bound);
+
+  {
+    pyOpenFHE::ScopedGILRelease release;
+
+    // every shard comes out of bootstrapping at the same level, so the first one
+    // tells us whether the series fits before we spend time on the rest
+    pyOpenFHE_CKKS::CKKSCiphertext first(
+        context->EvalBootstrap(shards[0].cipher));
+    int towers_after_bootstrap = first.getTowersRemaining();
+    if (towers_after_bootstrap - 2 < depth) {
+      throw std::runtime_error(fmt::format(
+          "Insufficient number of towers remaining after bootstrapping = {} "
+          "to evaluate this Chebyshev series of degree = {}, which needs "
+          "depth = {}",
+          towers_after_bootstrap, degree, depth));
+    }
+    shards[0].cipher = context->EvalChebyshevSeries(first.cipher, coefficients,
+                                                    -bound, bound);
+
+    std::string error;
+#pragma omp parallel for
+    for (int i = 1; i < num_ctxts; ++i) {
+      try {
+        auto bootstrapped = context->EvalBootstrap(shards[i].cipher);
+        shards[i].cipher = context->EvalChebyshevSeries(
+            bootstrapped, coefficients, -bound, bound);
+      } catch (const std::exception &e) {
+#pragma omp critical
+        if (error.empty()) {
+          error = e.what();
+        }
+      }
+    }
+    if (!error.empty()) {
+      throw std::runtime_error(error);
+    }
+  }
+
+  auto output_ctxts = pyOpenFHE::make_list(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    output_ctxts[i] = shards[i];
+  }
+  return boost::python::make_tuple(output_ctxts, (int)shards[0].getTowersRemaining() - 2);
+}
+
+namespace {
+
+/*
+tuneBootstrap replaces the rotation keys of one key tag with each candidate's,
+and the bootstrap precomputations for one slot count. This puts both back however
+tuneBootstrap is left: restore() throws if that fails, the destructor swallows it,
+since it only runs first when something else is already being thrown.
+Like everything touching OpenFHE's key maps, both run with the GIL held.
+*/
+class BootstrapTuningRestorer {
+public:
+  BootstrapTuningRestorer(CKKSCryptoContext &cc, const std::string &tag,
+                          uint32_t slots)
+      : cc(cc), tag(tag), slots(slots),
+        saved_keys(taggedEvalAutomorphismKeys(tag)) {
+    auto configs = cc.bootstrapConfigs();
+    auto configured = configs.find(slots);
+    if (configured != configs.end()) {
+      saved_config = configured->second;
+      has_config = true;
+    }
+  }
+
+  ~BootstrapTuningRestorer() {
+    try {
+      restore();
+    } catch (const std::exception &) {
+    }
+  }
+
+  BootstrapTuningRestorer(const BootstrapTuningRestorer &) = delete;
+  BootstrapTuningRestorer &operator=(const BootstrapTuningRestorer &) = delete;
+
+  void restore() {
+    if (restored) {
+      return;
+    }
+    restored = true;
+    CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys(tag);
+    if (saved_keys) {
+      CryptoContextImpl<DCRTPoly>::InsertEvalAutomorphismKey(saved_keys, tag);
+    }
+    if (has_config) {
+      cc.evalBootstrapSetup(saved_config.levelBudget, saved_config.bsgsDim,
+                            slots);
+    }
+  }
+
+private:
+  CKKSCryptoContext &cc;
+  std::string tag;
+  uint32_t slots;
+  std::shared_ptr<std::map<usint, EvalKey<DCRTPoly>>> saved_keys;
+  BootstrapConfig saved_config;
+  bool has_config = false;
+  bool restored = false;
+};
+
+} // namespace
+
+/*
+Each candidate gets its own EvalBootstrapSetup and EvalBootstrapKeyGen, then
+bootstraps a ciphertext of uniform random values in [-1, 1] trials times.
+The dict for each candidate has
+    levelBudget, bsgsDim: the setting that was tried
+    latency: average seconds per EvalBootstrap
+    towersRemaining: towers left on the bootstrapped ciphertext
+    precision: -log2 of the largest error in any slot, at most 52
+    numKeys, keyBytes: count and serialized size of the rotation keys it needs
+or error, if OpenFHE rejected that setting (e.g. it needs more depth than the context has).
+
+Key generation runs with the GIL held, since it writes OpenFHE's process-wide key maps,
+only the bootstraps being timed run without it.
+The rotation keys for privateKey are restored afterwards, even if tuning fails, and so is
+an evalBootstrapSetup for the batch size made before tuning. Without one, the precomputations
+of the last candidate are left, so call evalBootstrapSetup with the chosen setting before bootstrapping.
+*/
+list tuneBootstrap(CKKSCryptoContext &cc, const PrivateKey<DCRTPoly> &privateKey,
+                   const list &candidates, int trials) {
+  if (trials < 1) {
+    throw std::runtime_error(
+        fmt::format("Number of trials = {} must be at least 1", trials));
+  }
+
+  // parse everything up front, so a typo doesn't cost us half a tuning run
+  int num_candidates = len(candidates);
+  std::vector<std::vector<uint32_t>> level_budgets(num_candidates);
+  std::vector<std::vector<uint32_t>> bsgs_dims(num_candidates);
+  for (int i = 0; i < num_candidates; ++i) {
+    object candidate = candidates[i];
+    if (extract<int>(candidate[0]).check()) {
+      level_budgets[i] = pythonListToBootstrapPair(candidate, "levelBudget", 1);
+      bsgs_dims[i] = {0, 0};
+    } else {
+      level_budgets[i] = pythonListToBootstrapPair(candidate[0], "levelBudget", 1);
+      bsgs_dims[i] = pythonListToBootstrapPair(candidate[1], "bsgsDim", 0);
+    }
+  }
+
+  auto context = cc.context;
+  size_t slots = cc.getBatchSize();
+  std::string tag = privateKey->GetKeyTag();
+
+  std::vector<double> vals(slots);
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (auto &v : vals) {
+    v = dist(gen);
+  }
+  auto input = context->Encrypt(privateKey, cc.encode(vals));
+  input = context->GetScheme()->Compress(input, 2);
+
+  BootstrapTuningRestorer restorer(cc, tag, slots);
+
+  list results;
+  for (int i = 0; i < num_candidates; ++i) {
+    dict result;
+    result["levelBudget"] = boost::python::make_tuple(level_budgets[i][0], level_budgets[i][1]);
+    result["bsgsDim"] = boost::python::make_tuple(bsgs_dims[i][0], bsgs_dims[i][1]);
+
+    std::string error;
+    Ciphertext<DCRTPoly> output;
+    EvalAutomorphismKeyMap keys;
+    size_t key_bytes = 0;
+    double latency = 0.0;
+    try {
+      CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys(tag);
+      context->EvalBootstrapSetup(level_budgets[i], bsgs_dims[i], slots);
+      context->EvalBootstrapKeyGen(privateKey, slots);
+      auto tagged_keys = taggedEvalAutomorphismKeys(tag);
+      if (tagged_keys) {
+        keys[tag] = tagged_keys;
+      }
+
+      ScopedGILRelease release;
+      std::stringstream key_stream;
+      Serial::Serialize(keys, key_stream, SerType::BINARY);
+      key_bytes = key_stream.tellp();
+
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < trials; ++t) {
+        output = context->EvalBootstrap(input);
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      latency = elapsed.count() / trials;
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+
+    if (!error.empty()) {
+      result["error"] = error;
+      results.append(result);
+      continue;
+    }
+
+    auto decrypted = cc.decryptValues(privateKey, CKKSCiphertext(output));
+    double max_error = 0.0;
+    for (size_t j = 0; j < slots; ++j) {
+      max_error = std::max(max_error, std::abs(decrypted[j] - vals[j]));
+    }
+
+    result["latency"] = latency;
+    result["towersRemaining"] = CKKSCiphertext(output).getTowersRemaining();
+    result["precision"] = bitsOfPrecision(max_error);
+    result["numKeys"] = keys.empty() ? 0 : keys[tag]->size();
+    result["keyBytes"] = key_bytes;
+    results.append(result);
+  }
+
+  restorer.restore();
+  return results;
+}
+
+namespace {
+
+struct ParameterCandidate {
+  ScalingTechnique scalingTechnique;
+  usint scalingFactorBits;
+  usint firstModSize;
+  usint numLargeDigits;
+};
+
+struct ParameterResult {
+  ParameterCandidate candidate;
+  std::string error;
+  usint ringDim = 0;
+  size_t numTowers = 0;
+  usint modulusBits = 0;
+  double multLatency = 0.0;
+  double rotateLatency = 0.0;
+  double bootstrapLatency = 0.0;
+  double latency = 0.0;
+  size_t ciphertextBytes = 0;
+  size_t keyBytes = 0;
+  double precision = 0.0;
+  bool pareto = false;
+};
+
+// a dominates b if it's no worse in anything and better in something
+bool dominates(const ParameterResult &a, const ParameterResult &b) {
+  bool no_worse = a.latency <= b.latency &&
+                  a.ciphertextBytes <= b.ciphertextBytes &&
+                  a.keyBytes <= b.keyBytes && a.precision >= b.precision;
+  bool better = a.latency < b.latency ||
+                a.ciphertextBytes < b.ciphertextBytes ||
+                a.keyBytes < b.keyBytes || a.precision > b.precision;
+  return no_worse && better;
+}
+
+/*
+GenCryptoContext registers every context in CryptoContextFactory for good,
+along with its scheme and whatever EvalBootstrapSetup precomputed, which is GBs
+at the ring dimensions bootstrapping needs. The factory can only release all
+of them at once, but its registry is protected, so a subclass can drop just ours.
+Like registering, this must not race with anything deserializing.
+*/
+struct CandidateContexts : CryptoContextFactory<DCRTPoly> {
+  static size_t count() { return AllContexts.size(); }
+
+  // whether cc is the one context registered since there were count of them
+  static bool isNewest(const CryptoContext<DCRTPoly> &cc, size_t count) {
+    return AllContexts.size() == count + 1 && AllContexts.back() == cc;
+  }
+
+  static void release(const CryptoContext<DCRTPoly> &cc) {
+    AllContexts.erase(std::remove(AllContexts.begin(), AllContexts.end(), cc),
+                      AllContexts.end());
+  }
+};
+
+template <typename F> double averageSeconds(int trials, F op) {
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < trials; ++t) {
+    op();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / trials;
+}
+
+} // namespace
+
+/*
+The candidates are every combination of
+    scalingTechnique: FIXEDAUTO, FLEXIBLEAUTO
+    scalingFactorBits: precisionBits + 10, 15 and 20, at most 59
+    numLargeDigits: 1 to 4, with HYBRID key switching
+with firstModSize 10 bits above the scaling factor. If the workload bootstraps,
+the depth of bootstrapping with levelBudget (4, 4) is added on top of multiplicativeDepth.
+
+Each candidate is timed over trials EvalMult, EvalRotate and EvalBootstrap calls,
+latency is those weighted by workload (by default one mult and one rotation).
+precision is -log2 of the largest error after multiplicativeDepth multiplications, at most 52.
+The table has one dict per candidate, with pareto set on the ones that reach
+precisionBits and no other such candidate beats on every one of latency,
+ciphertextBytes, keyBytes and precision. Pareto candidates come first, then the
+rest by latency, then the ones OpenFHE rejected, which only have error.
+
+Candidates are generated and get their keys with the GIL held, since registering
+a context or a key can't race with other threads, and only the measurements run without it.
+Nothing of a candidate is kept once it has been measured: its keys are cleared
+and its context is unregistered, so the sweep needs the memory of one candidate.
+*/
+list tuneParameters(usint multiplicativeDepth, double precisionBits,
+                    SecurityLevel stdLevel, const object &workload,
+                    int trials) {
+  if (trials < 1) {
+    throw std::runtime_error(
+        fmt::format("Number of trials = {} must be at least 1", trials));
+  }
+
+  int mults = 1, rotations = 1, bootstraps = 0;
+  if (!workload.is_none()) {
+    dict ops = extract<dict>(workload);
+    list keys = ops.keys();
+    for (int i = 0; i < len(keys); ++i) {
+      std::string key = extract<std::string>(keys[i]);
+      if (key != "mults" && key != "rotations" && key != "bootstraps") {
+        throw std::runtime_error(fmt::format(
+            "Unknown workload operation = {}, expected mults, rotations or "
+            "bootstraps",
+            key));
+      }
+    }
+    mults = extract<int>(ops.get("mults", 0));
+    rotations = extract<int>(ops.get("rotations", 0));
+    bootstraps = extract<int>(ops.get("bootstraps", 0));
+  }
+
+  const std::vector<uint32_t> level_budget = {4, 4};
+  usint depth = multiplicativeDepth;
+  if (bootstraps > 0) {
+    depth += FHECKKSRNS::GetBootstrapDepth(level_budget, UNIFORM_TERNARY);
+  }
+
+  std::vector<ParameterCandidate> candidates;
+  std::set<usint> scaling_bits;
+  for (int margin : {10, 15, 20}) {
+    scaling_bits.insert(std::min(59, (int)std::ceil(precisionBits) + margin));
+  }
+  for (auto technique : {FIXEDAUTO, FLEXIBLEAUTO}) {
+    for (usint bits : scaling_bits) {
+      for (usint dnum = 1; dnum <= std::min<usint>(4, depth + 1); ++dnum) {
+        candidates.push_back({technique, bits, std::min<usint>(60, bits + 10),
+                              dnum});
+      }
+    }
+  }
+
+  std::vector<ParameterResult> results(candidates.size());
+  for (size_t c = 0; c < candidates.size(); ++c) {
+    auto &candidate = candidates[c];
+    auto &result = results[c];
+    result.candidate = candidate;
+
+    // registering a context isn't thread safe, so that happens with the GIL held
+    CKKSCryptoContext cc;
+    bool registered_here = false;
+    try {
+      size_t registered = CandidateContexts::count();
+      cc = genCKKSContext(depth, candidate.scalingFactorBits, 0, stdLevel, 0,
+                          candidate.scalingTechnique, HYBRID, UNIFORM_TERNARY,
+                          candidate.firstModSize, candidate.numLargeDigits);
+      registered_here = CandidateContexts::isNewest(cc.context, registered);
+      cc.context->Enable(PKE);
+      cc.context->Enable(KEYSWITCH);
+      cc.context->Enable(LEVELEDSHE);
+      if (bootstraps > 0) {
+        cc.context->Enable(ADVANCEDSHE);
+        cc.context->Enable(FHE);
+      }
+    } catch (const std::exception &e) {
+      result.error = e.what();
+      if (registered_here) {
+        CandidateContexts::release(cc.context);
+      }
+      continue;
+    }
+
+    {
+      auto context = cc.context;
+      std::string tag;
+      try {
+        // keygen writes OpenFHE's process-wide key maps, so it keeps the GIL
+        size_t slots = cc.getBatchSize();
+        auto keys = context->KeyGen();
+        tag = keys.secretKey->GetKeyTag();
+        context->EvalMultKeyGen(keys.secretKey);
+        context->EvalRotateKeyGen(keys.secretKey, {1});
+        if (bootstraps > 0) {
+          context->EvalBootstrapSetup(level_budget, {0, 0}, slots);
+          context->EvalBootstrapKeyGen(keys.secretKey, slots);
+        }
+        EvalMultKeyMap mult_keys = {
+            {tag, CryptoContextImpl<DCRTPoly>::GetEvalMultKeyVector(tag)}};
+        EvalAutomorphismKeyMap automorphism_keys = {
+            {tag, taggedEvalAutomorphismKeys(tag)}};
+
+        ScopedGILRelease release;
+        std::stringstream key_stream;
+        Serial::Serialize(mult_keys, key_stream, lbcrypto::SerType::BINARY);
+        Serial::Serialize(automorphism_keys, key_stream,
+                          lbcrypto::SerType::BINARY);
+        result.keyBytes = key_stream.tellp();
+
+        std::vector<double> vals(slots);
+        std::mt19937 gen(0);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        for (auto &v : vals) {
+          v = dist(gen);
+        }
+        auto x = context->Encrypt(keys.publicKey, cc.encode(vals));
+        auto ones = context->Encrypt(keys.publicKey,
+                                     cc.encode(std::vector<double>(slots, 1.0)));
+
+        std::stringstream ctxt_stream;
+        Serial::Serialize(x, ctxt_stream, lbcrypto::SerType::BINARY);
+        result.ciphertextBytes = ctxt_stream.tellp();
+        result.ringDim = context->GetRingDimension();
+        result.numTowers = x->GetElements()[0].GetNumOfElements();
+        result.modulusBits = context->GetModulus().GetMSB();
+
+        result.multLatency =
+            averageSeconds(trials, [&]() { context->EvalMult(x, ones); });
+        result.rotateLatency =
+            averageSeconds(trials, [&]() { context->EvalRotate(x, 1); });
+        if (bootstraps > 0) {
+          auto input = context->GetScheme()->Compress(x, 2);
+          result.bootstrapLatency = averageSeconds(
+              trials, [&]() { context->EvalBootstrap(input); });
+        }
+        result.latency = mults * result.multLatency +
+                         rotations * result.rotateLatency +
+                         bootstraps * result.bootstrapLatency;
+
+        auto y = x;
+        for (usint d = 0; d < multiplicativeDepth; ++d) {
+          y = context->EvalMult(y, ones);
+        }
+        Plaintext ptxt;
+        context->Decrypt(keys.secretKey, y, &ptxt);
+        ptxt->SetLength(slots);
+        auto decrypted = ptxt->GetRealPackedValue();
+        double max_error = 0.0;
+        for (size_t j = 0; j < slots; ++j) {
+          max_error = std::max(max_error, std::abs(decrypted[j] - vals[j]));
+        }
+        result.precision = bitsOfPrecision(max_error);
+      } catch (const std::exception &e) {
+        result.error = e.what();
+      }
+
+      // every candidate has its own keys, don't keep them all around
+      if (!tag.empty()) {
+        CryptoContextImpl<DCRTPoly>::ClearEvalMultKeys(tag);
+        CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys(tag);
+      }
+    }
+
+    // once cc goes out of scope nothing holds the context, and its bootstrap
+    // precomputations go with it. A context that was already registered
+    // (one with the same parameters as a context of the caller's) stays.
+    if (registered_here) {
+      CandidateContexts::release(cc.context);
+    }
+  }
+
+  for (auto &a : results) {
+    if (!a.error.empty() || a.precision < precisionBits) {
+      continue;
+    }
+    a.pareto = true;
+    for (auto &b : results) {
+      if (b.error.empty() && b.precision >= precisionBits && dominates(b, a)) {
+        a.pareto = false;
+        break;
+      }
+    }
+  }
+  std::stable_sort(results.begin(), results.end(),
+                   [](const ParameterResult &a, const ParameterResult &b) {
+                     if (a.error.empty() != b.error.empty()) {
+                       return a.error.empty();
+                     }
+                     if (a.pareto != b.pareto) {
+                       return a.pareto;
+                     }
+                     return a.latency < b.latency;
+                   });
+
+  list table;
+  for (auto &result : results) {
+    dict row;
+    row["scalingTechnique"] = result.candidate.scalingTechnique;
+    row["scalingFactorBits"] = result.candidate.scalingFactorBits;
+    row["firstModSize"] = result.candidate.firstModSize;
+    row["keySwitchTechnique"] = HYBRID;
+    row["numLargeDigits"] = result.candidate.numLargeDigits;
+    row["multiplicativeDepth"] = depth;
+    if (!result.error.empty()) {
+      row["error"] = result.error;
+      table.append(row);
+      continue;
+    }
+    row["ringDim"] = result.ringDim;
+    row["numTowers"] = result.numTowers;
+    row["modulusBits"] = result.modulusBits;
+    row["multLatency"] = result.multLatency;
+    row["rotateLatency"] = result.rotateLatency;
+    if (bootstraps > 0) {
+      row["bootstrapLatency"] = result.bootstrapLatency;
+    }
+    row["latency"] = result.latency;
+    row["ciphertextBytes"] = result.ciphertextBytes;
+    row["keyBytes"] = result.keyBytes;
+    row["precision"] = result.precision;
+    row["pareto"] = result.pareto;
+    table.append(row);
+  }
+  return table;
+}
+
 // make rotation keys for all of the +/- powers-of-2
 // we should probably try and put all the scheme-agnostic functions somewhere
 // neutral reduce code duplication and C++ won't complain about it if we ever
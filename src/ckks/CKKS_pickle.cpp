@@ -14,6 +14,7 @@ define all the serialization functions which operate on our wrapped ciphertext,
 #include "ckks/CKKS_key_operations.hpp"
 #include "ckks/CKKS_pickle.hpp"
 #include "ckks/serialization.hpp"
+#include "utils/mmap.hpp"
 #include "utils/utils.hpp"
 #include "utils/enums_binding.hpp"
 
@@ -32,14 +33,75 @@ boost::python::tuple CKKSCiphertext_pickle_suite::getinitargs(const pyOpenFHE_CK
     return boost::python::make_tuple();
 }
 
+/*
+Ciphertexts are pickled as (version, binary bytes).
+Pickles from before the binary format are a 1-tuple of JSON bytes, and still load.
+*/
+const int ciphertext_pickle_version = 1;
+
+boost::python::object binaryCiphertextState(const pyOpenFHE_CKKS::CKKSCiphertext& w) {
+    PyObject * py_buffer = SerializeToBytes_Ciphertext(w, pyOpenFHE_CKKS::SerType::BINARY);
+    boost::python::handle<> handle(py_buffer);
+    return boost::python::object(handle);
+}
+
 boost::python::tuple CKKSCiphertext_pickle_suite::getstate(const pyOpenFHE_CKKS::CKKSCiphertext& w) {
-    PyObject * py_buffer = SerializeToBytes_Ciphertext(w, pyOpenFHE_CKKS::SerType::JSON);
+    return boost::python::make_tuple(ciphertext_pickle_version, binaryCiphertextState(w));
+}
+
+void CKKSCiphertext_pickle_suite::setstate(pyOpenFHE_CKKS::CKKSCiphertext& w, boost::python::tuple state) {
+    using namespace boost::python;
+    if (len(state) == 1) {
+        auto ctxt = DeserializeFromBytes_Ciphertext(state[0], pyOpenFHE_CKKS::SerType::JSON);
+        w.cipher = ctxt.cipher;
+        return;
+    }
+
+    if (len(state) != 2 || extract<int>(state[0]) != ciphertext_pickle_version) {
+        PyErr_SetObject(
+        PyExc_ValueError,
+        ("expected (version, bytes) tuple in call to __setstate__; got %s" % state).ptr()
+        );
+        throw_error_already_set();
+    }
+
+    // with protocol 5 this may be an out of band buffer, which we read in place.
+    // the GIL stays held, deserializing registers the context in CryptoContextFactory
+    pyOpenFHE::ScopedBuffer buffer(state[1]);
+    Ciphertext<DCRTPoly> obj;
+    pyOpenFHE::MemoryIStream is(buffer.data(), buffer.size());
+    Serial::Deserialize(obj, is, lbcrypto::SerType::BINARY);
+    w.cipher = obj;
+}
+
+/*
+Protocol 5 lets the payload travel out of band as a PickleBuffer,
+so multiprocessing and Ray can hand it over without copying it into the pickle stream.
+Older protocols get exactly what __reduce__ would give them.
+*/
+boost::python::object CKKSCiphertext_pickle_suite::reduce_ex(boost::python::object self, int protocol) {
+    using namespace boost::python;
+    const pyOpenFHE_CKKS::CKKSCiphertext& w = extract<const pyOpenFHE_CKKS::CKKSCiphertext&>(self);
+    object payload = binaryCiphertextState(w);
+    if (protocol >= 5) {
+        payload = object(handle<>(PyPickleBuffer_FromObject(payload.ptr())));
+    }
+    return make_tuple(self.attr("__class__"), make_tuple(), make_tuple(ciphertext_pickle_version, payload));
+}
+
+boost::python::tuple CKKSCryptoContext_pickle_suite::getinitargs(const pyOpenFHE_CKKS::CKKSCryptoContext& w) {
+    return boost::python::make_tuple();
+}
+
+// contexts are big and only ever read back by us, so these are binary
+boost::python::tuple CKKSCryptoContext_pickle_suite::getstate(const pyOpenFHE_CKKS::CKKSCryptoContext& w) {
+    PyObject * py_buffer = SerializeToBytes_CryptoContext(w, pyOpenFHE_CKKS::SerType::BINARY);
     boost::python::handle<> handle(py_buffer);
     auto object = boost::python::object(handle);
     return boost::python::make_tuple(object);
 }
 
-void CKKSCiphertext_pickle_suite::setstate(pyOpenFHE_CKKS::CKKSCiphertext& w, boost::python::tuple state) {
+void CKKSCryptoContext_pickle_suite::setstate(pyOpenFHE_CKKS::CKKSCryptoContext& w, boost::python::tuple state) {
     using namespace boost::python;
     if (len(state) != 1) {
         PyErr_SetObject(
@@ -49,8 +111,8 @@ void CKKSCiphertext_pickle_suite::setstate(pyOpenFHE_CKKS::CKKSCiphertext& w, bo
         throw_error_already_set();
     }
 
-    auto ctxt = DeserializeFromBytes_Ciphertext(state[0], pyOpenFHE_CKKS::SerType::JSON);
-    w.cipher = ctxt.cipher;
+    auto cc = DeserializeFromBytes_CryptoContext(state[0], pyOpenFHE_CKKS::SerType::BINARY);
+    w.context = cc.context;
 }
 
 }
\ No newline at end of file
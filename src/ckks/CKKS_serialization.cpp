@@ -5,15 +5,29 @@ define all the serialization functions which operate on our wrapped ciphertext,
 crypto context, and keys here
 */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <set>
 #include <stdexcept>
 
+// string formatting for exceptions
+#include <fmt/format.h>
+
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
 
 #include "ckks/CKKS_ciphertext_extension.hpp"
 #include "ckks/CKKS_key_operations.hpp"
 #include "ckks/serialization.hpp"
+#include "utils/bundle.hpp"
+#include "utils/bytes_stream.hpp"
+#include "utils/container.hpp"
 #include "utils/enums_binding.hpp"
+#include "utils/eval_keys.hpp"
+#include "utils/mmap.hpp"
+#include "utils/seeded.hpp"
 #include "utils/utils.hpp"
 
 // header files needed for serialization
@@ -29,7 +43,7 @@ namespace pyOpenFHE_CKKS {
 
 PyObject *SerializeToBytes_Ciphertext(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
                                       const pyOpenFHE_CKKS::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     Serial::Serialize(obj.cipher, ss, lbcrypto::SerType::BINARY);
@@ -37,25 +51,14 @@ PyObject *SerializeToBytes_Ciphertext(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
     Serial::Serialize(obj.cipher, ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 pyOpenFHE_CKKS::CKKSCiphertext
 DeserializeFromBytes_Ciphertext(boost::python::object py_buffer,
                                 const pyOpenFHE_CKKS::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   Ciphertext<DCRTPoly> obj;
 
@@ -70,7 +73,7 @@ DeserializeFromBytes_Ciphertext(boost::python::object py_buffer,
 
 PyObject *SerializeToBytes_PublicKey(const PublicKey<DCRTPoly> &obj,
                                      const pyOpenFHE_CKKS::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     Serial::Serialize(obj, ss, lbcrypto::SerType::BINARY);
@@ -78,25 +81,14 @@ PyObject *SerializeToBytes_PublicKey(const PublicKey<DCRTPoly> &obj,
     Serial::Serialize(obj, ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 PublicKey<DCRTPoly>
 DeserializeFromBytes_PublicKey(boost::python::object py_buffer,
                                const pyOpenFHE_CKKS::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   PublicKey<DCRTPoly> obj;
 
@@ -111,7 +103,7 @@ DeserializeFromBytes_PublicKey(boost::python::object py_buffer,
 
 PyObject *SerializeToBytes_PrivateKey(const PrivateKey<DCRTPoly> &obj,
                                       const pyOpenFHE_CKKS::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     Serial::Serialize(obj, ss, lbcrypto::SerType::BINARY);
@@ -119,27 +111,101 @@ PyObject *SerializeToBytes_PrivateKey(const PrivateKey<DCRTPoly> &obj,
     Serial::Serialize(obj, ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 PrivateKey<DCRTPoly>
 DeserializeFromBytes_PrivateKey(boost::python::object py_buffer,
                                 const pyOpenFHE_CKKS::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
+
+  PrivateKey<DCRTPoly> obj;
+
+  if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
+    Serial::Deserialize(obj, ss, lbcrypto::SerType::BINARY);
+  } else if (sertype == pyOpenFHE_CKKS::SerType::JSON) {
+    Serial::Deserialize(obj, ss, lbcrypto::SerType::JSON);
+  }
+
+  return obj;
+}
+
+/*
+Serializes into a caller's writable buffer (bytearray, memoryview, numpy array, ...),
+so it can be reused across calls. Returns the number of bytes written, and throws
+with the size that would have been needed if the buffer is too small.
+*/
+template <typename T>
+size_t serializeIntoBuffer(const T &obj, const boost::python::object &buffer,
+                           const pyOpenFHE_CKKS::SerType sertype) {
+  return pyOpenFHE::serializeInto(buffer, [&](std::ostream &os) {
+    if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
+      Serial::Serialize(obj, os, lbcrypto::SerType::BINARY);
+    } else if (sertype == pyOpenFHE_CKKS::SerType::JSON) {
+      Serial::Serialize(obj, os, lbcrypto::SerType::JSON);
+    }
+  });
+}
+
+size_t SerializeInto_Ciphertext(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_CKKS::SerType sertype) {
+  return serializeIntoBuffer(obj.cipher, buffer, sertype);
+}
+
+size_t SerializeInto_PublicKey(const PublicKey<DCRTPoly> &obj,
+                               const boost::python::object &buffer,
+                               const pyOpenFHE_CKKS::SerType sertype) {
+  return serializeIntoBuffer(obj, buffer, sertype);
+}
+
+size_t SerializeInto_PrivateKey(const PrivateKey<DCRTPoly> &obj,
+                                const boost::python::object &buffer,
+                                const pyOpenFHE_CKKS::SerType sertype) {
+  return serializeIntoBuffer(obj, buffer, sertype);
+}
+
+/*
+Serial::Deserialize registers the context with CryptoContextFactory, and hands
+back the already registered context if one with the same parameters exists.
+Keys and ciphertexts deserialized afterwards look their context up the same
+way, so they all end up sharing this one.
+*/
+CKKSCryptoContext checkedContext(const CryptoContext<DCRTPoly> &cc,
+                               const std::string &source) {
+  if (!cc) {
+    throw std::runtime_error("Could not deserialize a CryptoContext from " +
+                             source);
+  }
+  if (cc->getSchemeId() != CKKSRNS_SCHEME) {
     throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
+        fmt::format("Deserialized CryptoContext from {} is not a CKKS context",
+                    source));
   }
+  return CKKSCryptoContext(cc);
+}
 
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+PyObject *SerializeToBytes_CryptoContext(const CKKSCryptoContext &obj,
+                                         const pyOpenFHE_CKKS::SerType sertype) {
+  pyOpenFHE::BytesOStream ss;
 
-  PrivateKey<DCRTPoly> obj;
+  if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
+    Serial::Serialize(obj.context, ss, lbcrypto::SerType::BINARY);
+  } else if (sertype == pyOpenFHE_CKKS::SerType::JSON) {
+    Serial::Serialize(obj.context, ss, lbcrypto::SerType::JSON);
+  }
+
+  return ss.release();
+}
+
+CKKSCryptoContext
+DeserializeFromBytes_CryptoContext(boost::python::object py_buffer,
+                                   const pyOpenFHE_CKKS::SerType sertype) {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
+
+  CryptoContext<DCRTPoly> obj;
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     Serial::Deserialize(obj, ss, lbcrypto::SerType::BINARY);
@@ -147,12 +213,12 @@ DeserializeFromBytes_PrivateKey(boost::python::object py_buffer,
     Serial::Deserialize(obj, ss, lbcrypto::SerType::JSON);
   }
 
-  return obj;
+  return checkedContext(obj, "bytes");
 }
 
 PyObject *SerializeToBytes_EvalMultKey_CryptoContext(
     CKKSCryptoContext &self, const pyOpenFHE_CKKS::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     self.context->SerializeEvalMultKey(ss, lbcrypto::SerType::BINARY);
@@ -160,25 +226,14 @@ PyObject *SerializeToBytes_EvalMultKey_CryptoContext(
     self.context->SerializeEvalMultKey(ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 bool DeserializeFromBytes_EvalMultKey_CryptoContext(
     CKKSCryptoContext &self, boost::python::object py_buffer,
     const pyOpenFHE_CKKS::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     self.context->DeserializeEvalMultKey(ss, lbcrypto::SerType::BINARY);
@@ -191,7 +246,7 @@ bool DeserializeFromBytes_EvalMultKey_CryptoContext(
 
 PyObject *SerializeToBytes_EvalAutomorphismKey_CryptoContext(
     CKKSCryptoContext &self, const pyOpenFHE_CKKS::SerType sertype) {
-  std::stringstream ss;
+  pyOpenFHE::BytesOStream ss;
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     self.context->SerializeEvalAutomorphismKey(ss, lbcrypto::SerType::BINARY);
@@ -199,25 +254,14 @@ PyObject *SerializeToBytes_EvalAutomorphismKey_CryptoContext(
     self.context->SerializeEvalAutomorphismKey(ss, lbcrypto::SerType::JSON);
   }
 
-  std::string result = ss.str();
-  PyObject *pymemview = PyMemoryView_FromMemory((char *)result.c_str(),
-                                                result.length(), PyBUF_READ);
-  return PyBytes_FromObject(pymemview);
+  return ss.release();
 }
 
 bool DeserializeFromBytes_EvalAutomorphismKey_CryptoContext(
     CKKSCryptoContext &self, boost::python::object py_buffer,
     const pyOpenFHE_CKKS::SerType sertype) {
-  std::string object_classname = boost::python::extract<std::string>(
-      py_buffer.attr("__class__").attr("__name__"));
-  if (object_classname != "bytes") {
-    throw std::runtime_error(
-        "expected object of type bytes, instead received type: " +
-        object_classname);
-  }
-
-  std::string buffer = boost::python::extract<std::string>(py_buffer);
-  std::stringstream ss(buffer);
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  pyOpenFHE::MemoryIStream ss(buffer.data(), buffer.size());
 
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     self.context->DeserializeEvalAutomorphismKey(ss, lbcrypto::SerType::BINARY);
@@ -247,17 +291,79 @@ bool SerializeToFile_Ciphertext(const std::string &filename,
   return success;
 }
 
+/*
+Decryption only needs the ciphertext modulus to exceed twice the scaled values,
+and Decrypt compresses to 2 towers anyway, so a ciphertext that's only going to be
+decrypted can drop every tower above that before it's written.
+CKKS precision comes from the scaling factor and the noise, which compressing leaves alone,
+so the only thing to ask for is headroom: the largest magnitude of the encrypted values.
+*/
+size_t towersForDecryption(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+                           double maxMagnitude) {
+  if (maxMagnitude <= 0.0) {
+    throw std::runtime_error(fmt::format(
+        "maxMagnitude = {} of the encrypted values must be positive",
+        maxMagnitude));
+  }
+  const auto &moduli = obj.cipher->GetElements()[0].GetParams()->GetParams();
+  double needed_bits = std::log2(obj.cipher->GetScalingFactor()) +
+                       std::log2(maxMagnitude) + 1;
+
+  size_t towers = 0;
+  double bits = 0.0;
+  for (const auto &modulus : moduli) {
+    bits += std::log2(modulus->GetModulus().ConvertToDouble());
+    towers++;
+    if (towers >= 2 && bits > needed_bits) {
+      break;
+    }
+  }
+  return towers;
+}
+
+pyOpenFHE_CKKS::CKKSCiphertext
+trimForDecryption(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+                  double maxMagnitude) {
+  size_t towers = towersForDecryption(obj, maxMagnitude);
+  if (towers >= obj.getTowersRemaining()) {
+    return obj;
+  }
+  return obj.compress(towers);
+}
+
+PyObject *
+SerializeToBytes_TrimmedCiphertext(const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+                                   const pyOpenFHE_CKKS::SerType sertype,
+                                   bool trim, double maxMagnitude) {
+  if (!trim) {
+    return SerializeToBytes_Ciphertext(obj, sertype);
+  }
+  return SerializeToBytes_Ciphertext(trimForDecryption(obj, maxMagnitude),
+                                     sertype);
+}
+
+bool SerializeToFile_TrimmedCiphertext(
+    const std::string &filename, const pyOpenFHE_CKKS::CKKSCiphertext &obj,
+    const pyOpenFHE_CKKS::SerType sertype, bool trim, double maxMagnitude) {
+  if (!trim) {
+    return SerializeToFile_Ciphertext(filename, obj, sertype);
+  }
+  return SerializeToFile_Ciphertext(
+      filename, trimForDecryption(obj, maxMagnitude), sertype);
+}
+
 bool SerializeToFile_CryptoContext(const std::string &filename,
                                    const CKKSCryptoContext &obj,
                                    const pyOpenFHE_CKKS::SerType sertype) {
-  // throw std::runtime_error("This function is disabled as CryptoContext
-  // Deserialization is broken.");
-
+  // the context itself rather than our wrapper, so it reads back as a
+  // CryptoContext and goes through OpenFHE's context factory
   bool success = false;
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
-    success = Serial::SerializeToFile(filename, obj, lbcrypto::SerType::BINARY);
+    success = Serial::SerializeToFile(filename, obj.context,
+                                      lbcrypto::SerType::BINARY);
   } else if (sertype == pyOpenFHE_CKKS::SerType::JSON) {
-    success = Serial::SerializeToFile(filename, obj, lbcrypto::SerType::JSON);
+    success =
+        Serial::SerializeToFile(filename, obj.context, lbcrypto::SerType::JSON);
   }
 
   if (!success) {
@@ -385,26 +491,12 @@ DeserializeFromFile_Ciphertext(const std::string &filename,
   return pyOpenFHE_CKKS::CKKSCiphertext(obj);
 }
 
-CryptoContext<DCRTPoly>
+CKKSCryptoContext
 DeserializeFromFile_CryptoContext(const std::string &filename,
                                   const pyOpenFHE_CKKS::SerType sertype) {
-  throw std::runtime_error(
-      "This function is disabled as CryptoContext Deserialization is broken.");
-
-  std::cout << "hello we started the deserialization function" << std::endl;
-
-  lbcrypto::CryptoContextFactory<lbcrypto::DCRTPoly>::ReleaseAllContexts();
-
-  std::cout << "contexts are released" << std::endl;
-
   CryptoContext<DCRTPoly> obj;
   bool success = false;
 
-  std::cout << "new contexts is created" << std::endl;
-
-  // obj->ClearEvalMultKeys();
-  // obj->ClearEvalAutomorphismKeys();
-
   if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
     success =
         Serial::DeserializeFromFile(filename, obj, lbcrypto::SerType::BINARY);
@@ -417,16 +509,7 @@ DeserializeFromFile_CryptoContext(const std::string &filename,
     throw std::runtime_error("Could not read serialized data from file: " +
                              filename);
   }
-
-  std::cout << "deserialization maybe happened" << std::endl;
-
-  auto cc = obj;
-  std::cout << "CKKS scheme is using ring dimension = "
-            << cc->GetRingDimension() << std::endl;
-  std::cout << "batch size = " << cc->GetEncodingParams()->GetBatchSize()
-            << std::endl;
-
-  return obj;
+  return checkedContext(obj, filename);
 }
 
 PublicKey<DCRTPoly>
@@ -522,4 +605,643 @@ bool DeserializeFromFile_EvalAutomorphismKey_CryptoContext(
   return success;
 }
 
+/*
+A bootstrapping state file holds everything evalBootstrapSetup and evalBootstrapKeyGen
+leave behind, so a new process doesn't have to redo the key generation:
+    the magic bytes, a version, the batch size and ring dimension it was made for,
+    every (slots, levelBudget, bsgsDim) evalBootstrapSetup was called with,
+    the EvalMult keys and the EvalAutomorphism keys of this context only,
+    each as a length and OpenFHE BINARY data.
+OpenFHE doesn't expose the CoeffsToSlots / SlotsToCoeffs plaintexts themselves,
+so loading replays evalBootstrapSetup for every slot count, which is the cheap part.
+*/
+const char bootstrap_state_magic[8] = {'P', 'Y', 'O', 'F', 'H', 'E', 'B', 'S'};
+const uint32_t bootstrap_state_version = 1;
+
+template <typename T> void writeRaw(std::ostream &os, T value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T readRaw(const char *&ptr, const char *end) {
+  if (end - ptr < (std::ptrdiff_t)sizeof(T)) {
+    throw std::runtime_error("Bootstrapping state file is truncated");
+  }
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  ptr += sizeof(T);
+  return value;
+}
+
+// writes a placeholder length, lets serialize write the data, then fills the length in
+template <typename F> void writeLengthPrefixed(std::ostream &os, F serialize) {
+  auto length_pos = os.tellp();
+  writeRaw<uint64_t>(os, 0);
+  auto start = os.tellp();
+  serialize(os);
+  auto end = os.tellp();
+  os.seekp(length_pos);
+  writeRaw<uint64_t>(os, end - start);
+  os.seekp(end);
+}
+
+bool SerializeToFile_BootstrapState_CryptoContext(
+    CKKSCryptoContext &self, const std::string &filename) {
+  auto configs = self.bootstrapConfigs();
+  if (configs.empty()) {
+    throw std::runtime_error(
+        "No bootstrapping state to save, call evalBootstrapSetup first");
+  }
+
+  // only this context's keys, copied out while we hold the GIL
+  auto mult_keys = pyOpenFHE::contextEvalMultKeys(self.context);
+  auto automorphism_keys = pyOpenFHE::contextEvalAutomorphismKeys(self.context);
+  if (mult_keys.empty() || automorphism_keys.empty()) {
+    throw std::runtime_error(
+        "No bootstrapping keys to save for this CryptoContext, call "
+        "evalMultKeyGen and evalBootstrapKeyGen first");
+  }
+
+  std::ofstream file(filename, std::ios::out | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error(
+        "Could not write bootstrapping state to file: " + filename);
+  }
+
+  pyOpenFHE::ScopedGILRelease release;
+
+  file.write(bootstrap_state_magic, sizeof(bootstrap_state_magic));
+  writeRaw<uint32_t>(file, bootstrap_state_version);
+  writeRaw<uint32_t>(file, self.getBatchSize());
+  writeRaw<uint32_t>(file, self.getRingDimension());
+  writeRaw<uint32_t>(file, configs.size());
+  for (auto &config : configs) {
+    writeRaw<uint32_t>(file, config.first);
+    for (uint32_t v : config.second.levelBudget) {
+      writeRaw<uint32_t>(file, v);
+    }
+    for (uint32_t v : config.second.bsgsDim) {
+      writeRaw<uint32_t>(file, v);
+    }
+  }
+
+  writeLengthPrefixed(file, [&](std::ostream &os) {
+    Serial::Serialize(mult_keys, os, lbcrypto::SerType::BINARY);
+  });
+  writeLengthPrefixed(file, [&](std::ostream &os) {
+    Serial::Serialize(automorphism_keys, os, lbcrypto::SerType::BINARY);
+  });
+  file.close();
+
+  if (!file) {
+    throw std::runtime_error(
+        "Could not write bootstrapping state to file: " + filename);
+  }
+  return true;
+}
+
+/*
+The file is memory mapped, so OpenFHE reads the keys straight out of the page cache.
+This keeps the GIL: every key carries its context, which OpenFHE looks up or registers
+in CryptoContextFactory while parsing it, then the keys go into the process-wide key maps.
+*/
+bool DeserializeFromFile_BootstrapState_CryptoContext(
+    CKKSCryptoContext &self, const std::string &filename) {
+  pyOpenFHE::MappedFile file(filename);
+  const char *ptr = file.data();
+  const char *end = file.data() + file.size();
+
+  if (file.size() < sizeof(bootstrap_state_magic) ||
+      std::memcmp(ptr, bootstrap_state_magic, sizeof(bootstrap_state_magic)) != 0) {
+    throw std::runtime_error("Not a bootstrapping state file: " + filename);
+  }
+  ptr += sizeof(bootstrap_state_magic);
+
+  uint32_t version = readRaw<uint32_t>(ptr, end);
+  if (version != bootstrap_state_version) {
+    throw std::runtime_error(fmt::format(
+        "Unsupported bootstrapping state version = {}, expected {}", version,
+        bootstrap_state_version));
+  }
+
+  uint32_t batch_size = readRaw<uint32_t>(ptr, end);
+  uint32_t ring_dim = readRaw<uint32_t>(ptr, end);
+  if (batch_size != self.getBatchSize() || ring_dim != self.getRingDimension()) {
+    throw std::runtime_error(fmt::format(
+        "Bootstrapping state was saved for batch size = {} and ring dimension "
+        "= {}, but this CryptoContext has {} and {}",
+        batch_size, ring_dim, self.getBatchSize(), self.getRingDimension()));
+  }
+
+  uint32_t num_configs = readRaw<uint32_t>(ptr, end);
+  std::map<uint32_t, BootstrapConfig> configs;
+  for (uint32_t i = 0; i < num_configs; ++i) {
+    uint32_t slots = readRaw<uint32_t>(ptr, end);
+    BootstrapConfig config;
+    for (int j = 0; j < 2; ++j) {
+      config.levelBudget.push_back(readRaw<uint32_t>(ptr, end));
+    }
+    for (int j = 0; j < 2; ++j) {
+      config.bsgsDim.push_back(readRaw<uint32_t>(ptr, end));
+    }
+    configs[slots] = config;
+  }
+
+  // EvalMult keys, then EvalAutomorphism keys
+  for (int section = 0; section < 2; ++section) {
+    uint64_t length = readRaw<uint64_t>(ptr, end);
+    if ((uint64_t)(end - ptr) < length) {
+      throw std::runtime_error("Bootstrapping state file is truncated: " +
+                               filename);
+    }
+    pyOpenFHE::MemoryIStream is(ptr, length);
+    bool success =
+        (section == 0)
+            ? self.context->DeserializeEvalMultKey(is, lbcrypto::SerType::BINARY)
+            : self.context->DeserializeEvalAutomorphismKey(
+                  is, lbcrypto::SerType::BINARY);
+    if (!success) {
+      throw std::runtime_error(
+          "Could not read bootstrapping keys from file: " + filename);
+    }
+    ptr += length;
+  }
+
+  for (auto &config : configs) {
+    self.evalBootstrapSetup(config.second.levelBudget, config.second.bsgsDim,
+                            config.first);
+  }
+  return true;
+}
+
+bool SerializeToFile_Bundle(const std::string &filename,
+                            CKKSCryptoContext &self,
+                            const boost::python::object &py_publicKey,
+                            const boost::python::object &py_privateKey) {
+  PublicKey<DCRTPoly> publicKey;
+  if (!py_publicKey.is_none()) {
+    publicKey = boost::python::extract<PublicKey<DCRTPoly>>(py_publicKey);
+  }
+  PrivateKey<DCRTPoly> privateKey;
+  if (!py_privateKey.is_none()) {
+    privateKey = boost::python::extract<PrivateKey<DCRTPoly>>(py_privateKey);
+  }
+
+  // only this context's keys, copied out while we hold the GIL
+  auto mult_keys = pyOpenFHE::contextEvalMultKeys(self.context);
+  auto automorphism_keys = pyOpenFHE::contextEvalAutomorphismKeys(self.context);
+
+  pyOpenFHE::ScopedGILRelease release;
+
+  using pyOpenFHE::BundleSection;
+  pyOpenFHE::BundleWriter writer(filename, CKKSRNS_SCHEME);
+
+  writer.addSection(BundleSection::CONTEXT, [&](std::ostream &os) {
+    Serial::Serialize(self.context, os, lbcrypto::SerType::BINARY);
+  });
+  if (publicKey) {
+    writer.addSection(BundleSection::PUBLIC_KEY, [&](std::ostream &os) {
+      Serial::Serialize(publicKey, os, lbcrypto::SerType::BINARY);
+    });
+  }
+  if (privateKey) {
+    writer.addSection(BundleSection::PRIVATE_KEY, [&](std::ostream &os) {
+      Serial::Serialize(privateKey, os, lbcrypto::SerType::BINARY);
+    });
+  }
+  writer.addSection(BundleSection::EVAL_MULT_KEYS, [&](std::ostream &os) {
+    Serial::Serialize(mult_keys, os, lbcrypto::SerType::BINARY);
+  });
+  writer.addSection(BundleSection::EVAL_AUTOMORPHISM_KEYS,
+                    [&](std::ostream &os) {
+                      Serial::Serialize(automorphism_keys, os,
+                                        lbcrypto::SerType::BINARY);
+                    });
+  writer.finish();
+  return true;
+}
+
+/*
+The context is always loaded, and first, so the keys resolve to it through
+the context factory. Everything else is only parsed if it's in sections
+(or sections is None), so a worker that never decrypts never reads the
+private key, and one that never rotates never reads the automorphism keys.
+The EvalMult and EvalAutomorphism keys go into the context, the rest are returned.
+All of it runs with the GIL held, since parsing the context and the keys registers
+the context in CryptoContextFactory and adds the keys to OpenFHE's process-wide maps.
+*/
+boost::python::dict
+DeserializeFromFile_Bundle(const std::string &filename,
+                           const boost::python::object &py_sections) {
+  using pyOpenFHE::BundleSection;
+
+  std::set<BundleSection> wanted;
+  bool everything = py_sections.is_none();
+  if (!everything) {
+    for (int i = 0; i < boost::python::len(py_sections); ++i) {
+      std::string name = boost::python::extract<std::string>(py_sections[i]);
+      wanted.insert(pyOpenFHE::bundleSectionByName(name));
+    }
+  }
+
+  CryptoContext<DCRTPoly> cc;
+  PublicKey<DCRTPoly> publicKey;
+  PrivateKey<DCRTPoly> privateKey;
+
+  pyOpenFHE::BundleReader reader(filename, CKKSRNS_SCHEME);
+  auto load = [&](BundleSection section) {
+    return everything ? reader.has(section) : wanted.count(section) > 0;
+  };
+
+  reader.readSection(BundleSection::CONTEXT, [&](std::istream &is) {
+    Serial::Deserialize(cc, is, lbcrypto::SerType::BINARY);
+  });
+  checkedContext(cc, filename);
+
+  if (load(BundleSection::PUBLIC_KEY)) {
+    reader.readSection(BundleSection::PUBLIC_KEY, [&](std::istream &is) {
+      Serial::Deserialize(publicKey, is, lbcrypto::SerType::BINARY);
+    });
+  }
+  if (load(BundleSection::PRIVATE_KEY)) {
+    reader.readSection(BundleSection::PRIVATE_KEY, [&](std::istream &is) {
+      Serial::Deserialize(privateKey, is, lbcrypto::SerType::BINARY);
+    });
+  }
+
+  bool success = true;
+  if (load(BundleSection::EVAL_MULT_KEYS)) {
+    reader.readSection(BundleSection::EVAL_MULT_KEYS, [&](std::istream &is) {
+      success = success &&
+                cc->DeserializeEvalMultKey(is, lbcrypto::SerType::BINARY);
+    });
+  }
+  if (load(BundleSection::EVAL_AUTOMORPHISM_KEYS)) {
+    reader.readSection(
+        BundleSection::EVAL_AUTOMORPHISM_KEYS, [&](std::istream &is) {
+          success = success && cc->DeserializeEvalAutomorphismKey(
+                                   is, lbcrypto::SerType::BINARY);
+        });
+  }
+  if (!success) {
+    throw std::runtime_error("Could not read keys from bundle: " + filename);
+  }
+
+  boost::python::dict result;
+  result["cryptoContext"] = CKKSCryptoContext(cc);
+  if (publicKey) {
+    result["publicKey"] = publicKey;
+  }
+  if (privateKey) {
+    result["privateKey"] = privateKey;
+  }
+  return result;
+}
+
+std::vector<Ciphertext<DCRTPoly>>
+extractCiphertexts(const boost::python::list &py_ctxts) {
+  int num_ctxts = boost::python::len(py_ctxts);
+  std::vector<Ciphertext<DCRTPoly>> ctxts(num_ctxts);
+  for (int i = 0; i < num_ctxts; ++i) {
+    ctxts[i] =
+        boost::python::extract<pyOpenFHE_CKKS::CKKSCiphertext>(py_ctxts[i])()
+            .cipher;
+  }
+  return ctxts;
+}
+
+std::vector<std::string>
+serializeCiphertextList(const std::vector<Ciphertext<DCRTPoly>> &ctxts,
+                        const pyOpenFHE_CKKS::SerType sertype) {
+  return pyOpenFHE::serializeShards(
+      ctxts.size(), [&](int i, std::ostream &shard) {
+        if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
+          Serial::Serialize(ctxts[i], shard, lbcrypto::SerType::BINARY);
+        } else if (sertype == pyOpenFHE_CKKS::SerType::JSON) {
+          Serial::Serialize(ctxts[i], shard, lbcrypto::SerType::JSON);
+        }
+      });
+}
+
+/*
+Deserializing a ciphertext looks up (and the first time, registers) its context
+in CryptoContextFactory, which isn't thread safe. So the first shard is read with
+the GIL held, and once it has registered the context the rest are only lookups,
+which go in parallel without it.
+*/
+boost::python::list readCiphertextList(const char *data, size_t size,
+                                       const std::string &source) {
+  pyOpenFHE::ContainerReader reader(data, size, CKKSRNS_SCHEME, source);
+  auto sertype = (pyOpenFHE_CKKS::SerType)reader.serType();
+  if (sertype != pyOpenFHE_CKKS::SerType::BINARY &&
+      sertype != pyOpenFHE_CKKS::SerType::JSON) {
+    throw std::runtime_error(fmt::format(
+        "Unknown SerType = {} in ciphertext list container {}",
+        reader.serType(), source));
+  }
+
+  int num_ctxts = reader.count();
+  std::vector<Ciphertext<DCRTPoly>> ctxts(num_ctxts);
+  auto deserialize = [&](int i) {
+    pyOpenFHE::MemoryIStream is(reader.shardData(i), reader.shardSize(i));
+    if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
+      Serial::Deserialize(ctxts[i], is, lbcrypto::SerType::BINARY);
+    } else {
+      Serial::Deserialize(ctxts[i], is, lbcrypto::SerType::JSON);
+    }
+  };
+
+  // registers the context, so this one keeps the GIL
+  if (num_ctxts > 0) {
+    deserialize(0);
+  }
+
+  std::string error;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 1; i < num_ctxts; ++i) {
+      try {
+        deserialize(i);
+      } catch (const std::exception &e) {
+#pragma omp critical
+        if (error.empty()) {
+          error = e.what();
+        }
+      }
+    }
+  }
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+
+  boost::python::list res = pyOpenFHE::make_list(ctxts.size());
+  for (size_t i = 0; i < ctxts.size(); ++i) {
+    res[i] = pyOpenFHE_CKKS::CKKSCiphertext(ctxts[i]);
+  }
+  return res;
+}
+
+PyObject *SerializeToBytes_CiphertextList(const boost::python::list &py_ctxts,
+                                          const pyOpenFHE_CKKS::SerType sertype) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+  std::vector<std::string> shards;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    shards = serializeCiphertextList(ctxts, sertype);
+  }
+  // writing into the bytes object needs the GIL again
+  return pyOpenFHE::serializeToPyBytes([&](std::ostream &os) {
+    pyOpenFHE::writeContainer(os, CKKSRNS_SCHEME, (uint32_t)sertype, shards);
+  });
+}
+
+boost::python::list
+DeserializeFromBytes_CiphertextList(boost::python::object py_buffer) {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  return readCiphertextList(buffer.data(), buffer.size(), "bytes");
+}
+
+bool SerializeToFile_CiphertextList(const std::string &filename,
+                                    const boost::python::list &py_ctxts,
+                                    const pyOpenFHE_CKKS::SerType sertype) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+
+  std::ofstream file(filename, std::ios::out | std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error(
+        "Could not write serialized ciphertext list to file: " + filename);
+  }
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    auto shards = serializeCiphertextList(ctxts, sertype);
+    pyOpenFHE::writeContainer(file, CKKSRNS_SCHEME, (uint32_t)sertype, shards);
+  }
+  file.close();
+
+  if (!file) {
+    throw std::runtime_error(
+        "Could not write serialized ciphertext list to file: " + filename);
+  }
+  return true;
+}
+
+boost::python::list
+DeserializeFromFile_CiphertextList(const std::string &filename) {
+  pyOpenFHE::MappedFile file(filename);
+  return readCiphertextList(file.data(), file.size(), filename);
+}
+
+PyObject *encryptSeededPlaintext(CKKSCryptoContext &self,
+                                 const PrivateKey<DCRTPoly> &privateKey,
+                                 const Plaintext &ptxt) {
+  auto seed = pyOpenFHE::freshSeed();
+  Ciphertext<DCRTPoly> compact;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    auto ctxt = self.context->Encrypt(privateKey, ptxt);
+    pyOpenFHE::reseedCiphertext(ctxt, privateKey, seed);
+    compact = pyOpenFHE::dropUniform(ctxt);
+  }
+  return pyOpenFHE::serializeToPyBytes([&](std::ostream &os) {
+    pyOpenFHE::writeSeededHeader(os, CKKSRNS_SCHEME, seed);
+    Serial::Serialize(compact, os, lbcrypto::SerType::BINARY);
+  });
+}
+
+PyObject *EncryptSeeded_CryptoContext(CKKSCryptoContext &self,
+                                      const PrivateKey<DCRTPoly> &privateKey,
+                                      const boost::python::list &pyvals) {
+  auto ptxt = self.encode(pyOpenFHE::pythonListToCppDoubleVector(pyvals));
+  return encryptSeededPlaintext(self, privateKey, ptxt);
+}
+
+PyObject *EncryptSeeded2_CryptoContext(CKKSCryptoContext &self,
+                                       const PrivateKey<DCRTPoly> &privateKey,
+                                       const ndarray &pyvals) {
+  auto ptxt = self.encode(pyOpenFHE::numpyListToCppDoubleVector(pyvals));
+  return encryptSeededPlaintext(self, privateKey, ptxt);
+}
+
+pyOpenFHE_CKKS::CKKSCiphertext
+DeserializeFromBytes_SeededCiphertext(boost::python::object py_buffer) {
+  pyOpenFHE::ScopedBuffer buffer(py_buffer);
+  const char *ptr = buffer.data();
+  const char *end = buffer.data() + buffer.size();
+  auto seed = pyOpenFHE::readSeededHeader(ptr, end, CKKSRNS_SCHEME, "bytes");
+
+  // deserializing registers the context, only expanding a needs no GIL
+  Ciphertext<DCRTPoly> obj;
+  pyOpenFHE::MemoryIStream is(ptr, end - ptr);
+  Serial::Deserialize(obj, is, lbcrypto::SerType::BINARY);
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    pyOpenFHE::restoreUniform(obj, seed);
+  }
+  return pyOpenFHE_CKKS::CKKSCiphertext(obj);
+}
+
+pyOpenFHE::RecordDeserializer
+recordDeserializer(uint32_t file_sertype, const std::string &filename) {
+  auto sertype = (pyOpenFHE_CKKS::SerType)file_sertype;
+  if (sertype != pyOpenFHE_CKKS::SerType::BINARY &&
+      sertype != pyOpenFHE_CKKS::SerType::JSON) {
+    throw std::runtime_error(
+        fmt::format("Unknown SerType = {} in ciphertext record file {}",
+                    file_sertype, filename));
+  }
+  return [sertype](const char *data, size_t size) {
+    Ciphertext<DCRTPoly> obj;
+    pyOpenFHE::MemoryIStream is(data, size);
+    if (sertype == pyOpenFHE_CKKS::SerType::BINARY) {
+      Serial::Deserialize(obj, is, lbcrypto::SerType::BINARY);
+    } else {
+      Serial::Deserialize(obj, is, lbcrypto::SerType::JSON);
+    }
+    return obj;
+  };
+}
+
+CiphertextWriter::CiphertextWriter(const std::string &filename,
+                                   const pyOpenFHE_CKKS::SerType sertype)
+    : sertype(sertype), writer(filename, CKKSRNS_SCHEME, (uint32_t)sertype) {}
+
+void CiphertextWriter::write(const pyOpenFHE_CKKS::CKKSCiphertext &ctxt) {
+  pyOpenFHE::ScopedGILRelease release;
+  std::vector<Ciphertext<DCRTPoly>> ctxts{ctxt.cipher};
+  writer.append(serializeCiphertextList(ctxts, sertype)[0]);
+}
+
+void CiphertextWriter::writeList(const boost::python::list &py_ctxts) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+  pyOpenFHE::ScopedGILRelease release;
+  for (auto &record : serializeCiphertextList(ctxts, sertype)) {
+    writer.append(record);
+  }
+}
+
+void CiphertextWriter::close() {
+  pyOpenFHE::ScopedGILRelease release;
+  writer.close();
+}
+
+CiphertextReader::CiphertextReader(const std::string &filename, int batchSize,
+                                   int prefetch)
+    : reader(filename, CKKSRNS_SCHEME),
+      deserialize(recordDeserializer(reader.serType(), filename)),
+      prefetcher(reader, deserialize, batchSize, prefetch) {
+  // the first ciphertext registers the context, with the GIL held and before
+  // any background thread starts, which then only look it up
+  if (reader.count() > 0) {
+    deserialize(reader.recordData(0), reader.recordSize(0));
+  }
+}
+
+pyOpenFHE_CKKS::CKKSCiphertext CiphertextReader::getItem(long i) const {
+  long count = reader.count();
+  if (i < 0) {
+    i += count;
+  }
+  if (i < 0 || i >= count) {
+    PyErr_SetString(PyExc_IndexError,
+                    "Ciphertext record index out of range");
+    boost::python::throw_error_already_set();
+  }
+
+  std::vector<Ciphertext<DCRTPoly>> ctxts;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    ctxts = pyOpenFHE::readRecords(reader, deserialize, i, 1);
+  }
+  return pyOpenFHE_CKKS::CKKSCiphertext(ctxts[0]);
+}
+
+boost::python::list CiphertextReader::read(long start, long count) const {
+  if (start < 0 || count < 0) {
+    throw std::runtime_error(fmt::format(
+        "Can't read {} ciphertext records starting at {}", count, start));
+  }
+
+  std::vector<Ciphertext<DCRTPoly>> ctxts;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    reader.willNeed(start, start + count);
+    ctxts = pyOpenFHE::readRecords(reader, deserialize, start, count);
+  }
+
+  boost::python::list py_ctxts;
+  for (auto &ctxt : ctxts) {
+    py_ctxts.append(pyOpenFHE_CKKS::CKKSCiphertext(ctxt));
+  }
+  return py_ctxts;
+}
+
+void CiphertextReader::restart() {
+  pyOpenFHE::ScopedGILRelease release;
+  prefetcher.restart(0);
+  batch.clear();
+  position = 0;
+}
+
+pyOpenFHE_CKKS::CKKSCiphertext CiphertextReader::next() {
+  if (position == batch.size()) {
+    pyOpenFHE::ScopedGILRelease release;
+    batch = prefetcher.next();
+    position = 0;
+  }
+  if (batch.empty()) {
+    PyErr_SetNone(PyExc_StopIteration);
+    boost::python::throw_error_already_set();
+  }
+  return pyOpenFHE_CKKS::CKKSCiphertext(batch[position++]);
+}
+
+boost::python::list CiphertextReader::readBatch() {
+  if (position == batch.size()) {
+    pyOpenFHE::ScopedGILRelease release;
+    batch = prefetcher.next();
+    position = 0;
+  }
+
+  boost::python::list py_ctxts;
+  for (; position < batch.size(); ++position) {
+    py_ctxts.append(pyOpenFHE_CKKS::CKKSCiphertext(batch[position]));
+  }
+  return py_ctxts;
+}
+
+bool SerializeToFile_CiphertextStore(const std::string &filename,
+                                     const boost::python::list &py_ctxts) {
+  auto ctxts = extractCiphertexts(py_ctxts);
+  pyOpenFHE::ScopedGILRelease release;
+  pyOpenFHE::writeCiphertextStore(filename, CKKSRNS_SCHEME, ctxts);
+  return true;
+}
+
+pyOpenFHE_CKKS::CKKSCiphertext CiphertextHandle::get() const {
+  Ciphertext<DCRTPoly> ctxt;
+  {
+    pyOpenFHE::ScopedGILRelease release;
+    ctxt = store->get(index);
+  }
+  return pyOpenFHE_CKKS::CKKSCiphertext(ctxt);
+}
+
+CiphertextStore::CiphertextStore(const std::string &filename,
+                                 const CKKSCryptoContext &cc, int cacheSize)
+    : store(std::make_shared<pyOpenFHE::MappedCiphertextStore>(
+          filename, cc.context, CKKSRNS_SCHEME, std::max(cacheSize, 0))) {}
+
+CiphertextHandle CiphertextStore::getItem(long i) const {
+  long count = store->count();
+  if (i < 0) {
+    i += count;
+  }
+  if (i < 0 || i >= count) {
+    PyErr_SetString(PyExc_IndexError, "Ciphertext store index out of range");
+    boost::python::throw_error_already_set();
+  }
+  return CiphertextHandle(store, i);
+}
+
 } // namespace pyOpenFHE_CKKS
\ No newline at end of file
@@ -3,16 +3,21 @@
 #include "ckks/CKKS_ciphertext_extension.hpp"
 #include "ckks/cnn/he_cnn.hpp"
 #include "ckks/cnn/conv.hpp"
+#include "ckks/cnn/pool.hpp"
 #include "utils/utils.hpp"
 #include "ckks/utils.hpp"
+#include "utils/reduce.hpp"
 
 #include <stdexcept>
+#include <fmt/format.h>
 
 #include <boost/python.hpp>
 #include <boost/python/numpy.hpp>
 #include <boost/python/scope.hpp>
 #include <omp.h>
 #include <cstdlib>
+#include <algorithm>
+#include <utility>
 
 using namespace pyOpenFHE;
 using namespace pyOpenFHE_CKKS;
@@ -137,6 +142,7 @@ pyOpenFHE_CKKS::CKKSCiphertext convolution_helper_channel_sharded(pyOpenFHE_CKKS
                                                                 boost_vector4d &filters,
                                                                 int mtx_size,
                                                                 int channel_index,
+                                                                int filter_index,
                                                                 int channel_shard_index,
                                                                 int output_channel_index) {
     auto first_shard = rotations[0][0][0][0];
@@ -180,7 +186,7 @@ pyOpenFHE_CKKS::CKKSCiphertext convolution_helper_channel_sharded(pyOpenFHE_CKKS
 
             auto mask = make_shift_mask_channel_shard(num_rows, num_cols, num_shift_ud, num_shift_lr);
             auto bleed_mask = make_shift_mask_bleed_channel_shard(num_rows, num_cols, num_shift_ud, num_shift_lr);
-            auto kernel_element = filters[channel_index][output_channel_index][ki][kj];
+            auto kernel_element = filters[filter_index][output_channel_index][ki][kj];
 
             // create masked kernel elements
             for (int i = 0; i < shard_size; i++) {
@@ -198,8 +204,154 @@ pyOpenFHE_CKKS::CKKSCiphertext convolution_helper_channel_sharded(pyOpenFHE_CKKS
     return enc_sum;
 }
 
+/*
+Grouped counterpart of convolution_helper_image_sharded. The output keeps the input's layout,
+so output slot idx holds channel sigma[idx] and only picks up input channels from its own group.
+*/
+pyOpenFHE_CKKS::CKKSCiphertext convolution_helper_image_sharded_grouped(const pyOpenFHE_CKKS::ciphertext_array2d &ciphertext_rotations,
+                                                boost_vector4d &filters,
+                                                int mtx_size,
+                                                int r,
+                                                int num_channels_per_shard,
+                                                int channels_per_group,
+                                                int fragment_offset,
+                                                int shard_offset,
+                                                std::vector<long int> &sigma) {
+    auto ciphertext = ciphertext_rotations[0][0];
+    int shard_size = ciphertext.getBatchSize();
+    int ker_size = filters.shape()[2];
+    int channel_size = mtx_size * mtx_size;
+    int num_physical_channels = shard_size / channel_size;
+    int dup_factor = shard_size / (num_channels_per_shard * channel_size);
+
+    auto enc_sum = ciphertext - ciphertext; // zero
+
+    std::vector<double> kernel_elements(num_physical_channels);
+    std::vector<double> masked_kernel_elements(shard_size);
+
+    for (int ki = 0; ki < ker_size; ki++) {
+        int num_shift_ud = kernel_index_to_shift(ki, ker_size);
+        for (int kj = 0; kj < ker_size; kj++) {
+            int num_shift_lr = kernel_index_to_shift(kj, ker_size);
+            auto mask = make_shift_mask_image_sharded(num_physical_channels, mtx_size, mtx_size, num_shift_ud, num_shift_lr);
+
+            for (int idx = 0; idx < num_physical_channels; idx++) {
+                int sigma_i = (int)sigma[(num_channels_per_shard * fragment_offset) + (idx / dup_factor + r) % num_channels_per_shard];
+                int sigma_j = (int)sigma[(num_channels_per_shard * shard_offset) + idx / dup_factor];
+                if (sigma_i / channels_per_group == sigma_j / channels_per_group) {
+                    kernel_elements[idx] = filters[sigma_i % channels_per_group][sigma_j][ki][kj];
+                } else {
+                    kernel_elements[idx] = 0.0;
+                }
+            }
+
+            for (int i = 0; i < shard_size; i++) {
+                int idx = ((i / channel_size) - (r * dup_factor) + num_physical_channels) % num_physical_channels;
+                masked_kernel_elements[i] = mask[i] * kernel_elements[idx];
+            }
+
+            enc_sum += ciphertext_rotations[ki][kj] * masked_kernel_elements;
+        }
+    }
+
+    enc_sum <<= (r * channel_size * dup_factor);
+
+    return enc_sum;
+}
+
+// rounds towards -inf, unlike /
+int floor_div(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+/*
+Multiplexed counterpart of convolution_helper_image_sharded for one input shard and one
+physical channel diagonal dp, i.e. output physical channel p reads input physical channel p + dp.
+A physical shift by (shift_ud, shift_lr) moves sub-channel offset a to a + shift_ud, which is
+kernel row floor((a + shift_ud) / gap) of input sub-channel offset (a + shift_ud) mod gap,
+so every slot works out its own kernel element and input channel from the shift.
+Slots only read from input sub-channels in the same block of in_block sub-channels,
+which with duplication picks exactly one copy of each input channel.
+*/
+pyOpenFHE_CKKS::CKKSCiphertext convolution_helper_multiplexed(const std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &ciphertext_rotations,
+                                                const std::vector<std::pair<int, int>> &shifts,
+                                                boost_vector4d &filters,
+                                                int mtx_size,
+                                                int gap,
+                                                int dp,
+                                                int num_in_channels_per_shard,
+                                                int num_out_channels_per_shard,
+                                                int fragment_offset,
+                                                int shard_offset,
+                                                std::vector<long int> &sigma) {
+    auto ciphertext = ciphertext_rotations[0];
+    int shard_size = ciphertext.getBatchSize();
+    int ker_size = filters.shape()[2];
+    int min_shift = kernel_index_to_shift(0, ker_size);
+    int max_shift = kernel_index_to_shift(ker_size - 1, ker_size);
+    int row_size = mtx_size * gap;
+    int channel_size = row_size * row_size;
+    int num_physical_channels = shard_size / channel_size;
+    int in_block = std::max(1, num_in_channels_per_shard / num_physical_channels);
+
+    auto enc_sum = ciphertext - ciphertext; // zero
+
+    std::vector<double> masked_kernel_elements(shard_size);
+
+    for (int n = 0; n < (int)shifts.size(); n++) {
+        int shift_ud = shifts[n].first;
+        int shift_lr = shifts[n].second;
+        bool nonzero = false;
+
+        // slot i is indexed before the final rotation by dp channels, so it sits in the input's physical channel
+        for (int i = 0; i < shard_size; i++) {
+            masked_kernel_elements[i] = 0.0;
+
+            int in_channel = i / channel_size;
+            int out_channel = (in_channel - dp + num_physical_channels) % num_physical_channels;
+            int row = (i % channel_size) / row_size;
+            int col = i % row_size;
+
+            int num_shift_ud = floor_div(row % gap + shift_ud, gap);
+            int num_shift_lr = floor_div(col % gap + shift_lr, gap);
+            if (num_shift_ud < min_shift || num_shift_ud > max_shift || num_shift_lr < min_shift || num_shift_lr > max_shift) {
+                continue;
+            }
+
+            // zero padding
+            int src_row = row / gap + num_shift_ud;
+            int src_col = col / gap + num_shift_lr;
+            if (src_row < 0 || src_row >= mtx_size || src_col < 0 || src_col >= mtx_size) {
+                continue;
+            }
+
+            int out_sub_channel = multiplexed_sub_channel(row % gap, col % gap, gap);
+            int in_sub_channel = multiplexed_sub_channel(row % gap + shift_ud - gap * num_shift_ud, col % gap + shift_lr - gap * num_shift_lr, gap);
+            if (in_sub_channel / in_block != out_sub_channel / in_block) {
+                continue;
+            }
+
+            int in_idx = (num_in_channels_per_shard * fragment_offset) + multiplexed_channel_index(in_channel, in_sub_channel, num_physical_channels, num_in_channels_per_shard);
+            int j = (num_out_channels_per_shard * shard_offset) + multiplexed_channel_index(out_channel, out_sub_channel, num_physical_channels, num_out_channels_per_shard);
+            int ki = shift_to_kernel_index(num_shift_ud, ker_size);
+            int kj = shift_to_kernel_index(num_shift_lr, ker_size);
+
+            masked_kernel_elements[i] = filters[(int)sigma[in_idx]][j][ki][kj];
+            nonzero = true;
+        }
+
+        if (nonzero) {
+            enc_sum += ciphertext_rotations[n] * masked_kernel_elements;
+        }
+    }
+
+    enc_sum <<= (dp * channel_size);
+
+    return enc_sum;
+}
+
 //  or not we have channel shards or not (can pretty easily do this by mathing it out, as below).
-boost::python::list conv2d_image_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> & shards, const ndarray &npfilters, int mtx_size, const ndarray &permutation) {
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> conv2d_image_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> & shards, const ndarray &npfilters, int mtx_size, const ndarray &permutation) {
     // convert to boost multiarray
     auto filters = numpyArrayToCppArray4D(npfilters);
     auto sigma = numpyListToCppLongIntVector(permutation);
@@ -268,27 +420,111 @@ boost::python::list conv2d_image_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphert
         }
     }
 
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> output_shards(num_output_shards);
-    #pragma omp parallel for
-    for (int s = 0; s < num_output_shards; s++) {
-        int idx = s * (num_in_channels_per_shard * num_input_shards);
-        auto ctxt = partial_convolutions[idx];
-        for(int offset = 1; offset < num_in_channels_per_shard * num_input_shards; ++offset) {
-            ctxt += partial_convolutions[idx + offset];
+    // each output shard is the sum of a contiguous run of partial convolutions
+    return parallelTreeSumGroups(partial_convolutions, num_output_shards, num_in_channels_per_shard * num_input_shards);
+}
+
+/*
+Grouped and depthwise convolutions on image shards. filters has shape (channels / groups, channels, k, k),
+i.e. the PyTorch grouped weight with its first two axes swapped like the dense filters,
+and the output has the same channels, layout and permutation as the input.
+A channel multiplier (more output than input channels) is rejected, conv2d_channel_sharded supports it.
+A partial is only computed for an (output shard, input shard, channel rotation) triple that lines up
+two channels of the same group, so a depthwise convolution of an unpermuted input never rotates channels.
+*/
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> conv2d_image_sharded_grouped(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &shards, const ndarray &npfilters, int mtx_size, const ndarray &permutation, int groups) {
+    auto filters = numpyArrayToCppArray4D(npfilters);
+    auto sigma = numpyListToCppLongIntVector(permutation);
+
+    int num_shards = shards.size();
+    int shard_size = shards[0].getBatchSize();
+    int channel_size = mtx_size * mtx_size;
+    int num_physical_channels_per_shard = shard_size / channel_size;
+    int channels_per_group = filters.shape()[0];
+    int num_channels = filters.shape()[1];
+    int ker_size = filters.shape()[2];
+
+    // the permutation has one entry per input channel
+    int num_input_channels = sigma.size();
+    if (num_channels != num_input_channels) {
+        if (num_input_channels > 0 && num_channels % num_input_channels == 0) {
+            throw std::runtime_error(fmt::format("grouped conv2d on image shards can't have more output channels ({}) than input channels ({}), a channel multiplier needs channel sharding", num_channels, num_input_channels));
+        }
+        throw std::runtime_error(fmt::format("grouped conv2d filters have {} channels, but the permutation has {} input channels", num_channels, num_input_channels));
+    }
+    if (channels_per_group * groups != num_channels) {
+        throw std::runtime_error(fmt::format("grouped conv2d on image shards needs filters of shape (channels / groups, channels, k, k), got ({}, {}) for {} groups", channels_per_group, num_channels, groups));
+    }
+    if ((num_shards > 1 && num_physical_channels_per_shard * num_shards != num_channels) ||
+        (num_shards == 1 && num_physical_channels_per_shard % num_channels != 0)) {
+        throw std::runtime_error(fmt::format("{} image shards of {} channels don't hold {} input channels", num_shards, num_physical_channels_per_shard, num_channels));
+    }
+    for (auto c : sigma) {
+        if (c < 0 || c >= num_channels) {
+            throw std::runtime_error(fmt::format("permutation entry {} is out of range for {} channels", c, num_channels));
         }
-        output_shards[s] = ctxt;
     }
 
-    boost::python::list res = pyOpenFHE::make_list(num_output_shards);
-    for(int s = 0 ; s < num_output_shards; ++s) {
-        res[s] = output_shards[s];
+    int num_channels_per_shard = (num_shards > 1) ? num_physical_channels_per_shard : num_channels;
+    int dup_factor = num_physical_channels_per_shard / num_channels_per_shard;
+
+    // (output shard, input shard, rotation) triples that line up channels of the same group, in output shard order
+    std::vector<std::vector<int>> partials;
+    std::vector<int> output_shard_start(num_shards + 1, 0);
+    for (int s = 0; s < num_shards; s++) {
+        for (int f = 0; f < num_shards; f++) {
+            for (int r = 0; r < num_channels_per_shard; ++r) {
+                bool needed = false;
+                for (int idx = 0; idx < num_physical_channels_per_shard && !needed; idx++) {
+                    int sigma_i = (int)sigma[(num_channels_per_shard * f) + (idx / dup_factor + r) % num_channels_per_shard];
+                    int sigma_j = (int)sigma[(num_channels_per_shard * s) + idx / dup_factor];
+                    needed = (sigma_i / channels_per_group == sigma_j / channels_per_group);
+                }
+                if (needed) {
+                    partials.push_back({s, f, r});
+                }
+            }
+        }
+        output_shard_start[s + 1] = partials.size();
     }
 
-    return res;
+    boost::multi_array<pyOpenFHE_CKKS::CKKSCiphertext, 3> all_ciphertext_rotations(boost::extents[num_shards][ker_size][ker_size]);
+    #pragma omp parallel for
+    for (int f = 0; f < num_shards; f++) {
+        all_ciphertext_rotations[f] = get_all_rotations_image_sharded(shards[f], mtx_size, ker_size);
+    }
+
+    int num_partials = partials.size();
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> partial_convolutions(num_partials);
+    #pragma omp parallel for
+    for (int p = 0; p < num_partials; p++) {
+        partial_convolutions[p] = convolution_helper_image_sharded_grouped(
+            all_ciphertext_rotations[partials[p][1]],
+            filters,
+            mtx_size,
+            partials[p][2],
+            num_channels_per_shard,
+            channels_per_group,
+            partials[p][1],
+            partials[p][0],
+            sigma
+        );
+    }
+
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> output_shards(num_shards);
+    for (int s = 0; s < num_shards; s++) {
+        std::vector<pyOpenFHE_CKKS::CKKSCiphertext> terms(partial_convolutions.begin() + output_shard_start[s], partial_convolutions.begin() + output_shard_start[s + 1]);
+        output_shards[s] = parallelTreeSum(terms);
+    }
+
+    return output_shards;
 }
 
-// entry point for channel sharding
-boost::python::list conv2d_channel_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &shards, const ndarray &npfilters, int mtx_size) {
+/*
+Entry point for channel sharding. With groups > 1, filters has shape (input channels / groups, output channels, k, k)
+and each output channel only sums over the input channels of its group.
+*/
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> conv2d_channel_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &shards, const ndarray &npfilters, int mtx_size, int groups) {
     auto filters = numpyArrayToCppArray4D(npfilters);
     auto first_shard = shards[0];
 
@@ -298,21 +534,28 @@ boost::python::list conv2d_channel_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphe
     int channel_size = mtx_size * mtx_size;
     int shards_per_channel = channel_size / shard_size;
     int num_input_channels = num_input_shards / shards_per_channel;
+    int in_channels_per_group = filters.shape()[0];
     int num_output_channels = filters.shape()[1];
     int ker_size = filters.shape()[2];
     int num_output_shards = num_output_channels * shards_per_channel;
 
+    if (in_channels_per_group * groups != num_input_channels || num_output_channels % groups != 0) {
+        throw std::runtime_error(fmt::format("conv2d with {} groups cannot map {} input channels to {} output channels with filters for {} input channels", groups, num_input_channels, num_output_channels, in_channels_per_group));
+    }
+    int out_channels_per_group = num_output_channels / groups;
+
     // cache partial computations here
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> partial_convolutions(num_input_channels * shards_per_channel * num_output_channels);
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> partial_convolutions(num_output_shards * in_channels_per_group);
 
     auto channel_shard_rotations = get_all_rotations_channel_sharded(shards, shards_per_channel, mtx_size, ker_size);
 
     // quintuply nested loop!
     #pragma omp parallel for collapse(3)
-    for (int input_channel_index = 0; input_channel_index < num_input_channels; input_channel_index++) {
+    for (int output_channel_index = 0; output_channel_index < num_output_channels; output_channel_index++) {
         for (int channel_shard_index = 0; channel_shard_index < shards_per_channel; channel_shard_index++) {
-            for (int output_channel_index = 0; output_channel_index < num_output_channels; output_channel_index++) {
-                int idx = input_channel_index * (shards_per_channel * num_output_channels) + output_channel_index * shards_per_channel + channel_shard_index;
+            for (int filter_index = 0; filter_index < in_channels_per_group; filter_index++) {
+                int input_channel_index = (output_channel_index / out_channels_per_group) * in_channels_per_group + filter_index;
+                int idx = (output_channel_index * shards_per_channel + channel_shard_index) * in_channels_per_group + filter_index;
 
                 // just pass in all shards since we'll need to reference adjacent ones
                 partial_convolutions[idx] = convolution_helper_channel_sharded(
@@ -320,6 +563,7 @@ boost::python::list conv2d_channel_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphe
                     filters,
                     mtx_size,
                     input_channel_index,
+                    filter_index,
                     channel_shard_index,
                     output_channel_index
                 );
@@ -327,38 +571,128 @@ boost::python::list conv2d_channel_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphe
         }
     }
 
-    // Sum up the partial_convolutions
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> output_shards(num_output_shards);
+    // output shard (output_channel_index * shards_per_channel + shard_index) sums one term per input channel of its group
+    return parallelTreeSumGroups(partial_convolutions, num_output_shards, in_channels_per_group);
+}
 
-    for (int output_channel_index = 0; output_channel_index < num_output_channels; output_channel_index++) {
+/*
+Entry point for the multiplexed layout (see he_cnn.hpp), which is always image sharded.
+The output is multiplexed with the same gap, and its channels are in order, so it takes the identity permutation.
+*/
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> conv2d_multiplexed(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &shards, const ndarray &npfilters, int mtx_size, int gap, const ndarray &permutation) {
+    auto filters = numpyArrayToCppArray4D(npfilters);
+    auto sigma = numpyListToCppLongIntVector(permutation);
 
-        // Loop over shards
-        for (int shard_index = 0; shard_index < shards_per_channel; shard_index++) {
+    int num_input_shards = shards.size();
+    int shard_size = shards[0].getBatchSize();
+    int row_size = mtx_size * gap;
+    int channel_size = row_size * row_size;
+    int num_physical_channels_per_shard = shard_size / channel_size;
+    int num_channels_per_shard = num_physical_channels_per_shard * gap * gap;
+    int num_input_channels = filters.shape()[0];
+    int num_output_channels = filters.shape()[1];
+    int ker_size = filters.shape()[2];
 
-            auto enc_sum = first_shard - first_shard; // zero
+    int num_in_channels_per_shard = (num_input_shards > 1) ? num_channels_per_shard : num_input_channels;
+    if (num_in_channels_per_shard * num_input_shards != num_input_channels || num_channels_per_shard % num_in_channels_per_shard != 0) {
+        throw std::runtime_error(fmt::format("{} input channels do not fill {} multiplexed shards of {} channels", num_input_channels, num_input_shards, num_channels_per_shard));
+    }
 
-            // Loop over input channels
-            for (int input_channel_index = 0; input_channel_index < num_input_channels; input_channel_index++) {
+    int num_output_shards = std::max(1, num_output_channels / num_channels_per_shard);
+    int num_out_channels_per_shard = (num_output_shards > 1) ? num_channels_per_shard : num_output_channels;
+    if (num_out_channels_per_shard * num_output_shards != num_output_channels || num_channels_per_shard % num_out_channels_per_shard != 0) {
+        throw std::runtime_error(fmt::format("{} output channels do not fill multiplexed shards of {} channels", num_output_channels, num_channels_per_shard));
+    }
 
-                // Calculate offset
-                int idx = input_channel_index * (shards_per_channel * num_output_channels) + output_channel_index * shards_per_channel + shard_index;
-                enc_sum += partial_convolutions[idx];
+    // a duplicated input only needs the diagonals that reach each distinct physical channel once
+    int diagonal_step = std::max(1, num_physical_channels_per_shard / num_in_channels_per_shard);
+    int num_diagonals = num_physical_channels_per_shard / diagonal_step;
+    int in_block = std::max(1, num_in_channels_per_shard / num_physical_channels_per_shard);
+
+    // physical shifts that some slot reads a kernel element through
+    int min_shift = kernel_index_to_shift(0, ker_size);
+    int max_shift = kernel_index_to_shift(ker_size - 1, ker_size);
+    int max_physical_shift = gap * std::max(-min_shift, max_shift) + gap - 1;
+    std::vector<std::pair<int, int>> shifts;
+    std::vector<int> rotation_indices;
+    for (int shift_ud = -max_physical_shift; shift_ud <= max_physical_shift; shift_ud++) {
+        for (int shift_lr = -max_physical_shift; shift_lr <= max_physical_shift; shift_lr++) {
+            bool used = false;
+            for (int a = 0; a < gap; a++) {
+                for (int b = 0; b < gap; b++) {
+                    int num_shift_ud = floor_div(a + shift_ud, gap);
+                    int num_shift_lr = floor_div(b + shift_lr, gap);
+                    int in_sub_channel = multiplexed_sub_channel(a + shift_ud - gap * num_shift_ud, b + shift_lr - gap * num_shift_lr, gap);
+                    used |= num_shift_ud >= min_shift && num_shift_ud <= max_shift
+                         && num_shift_lr >= min_shift && num_shift_lr <= max_shift
+                         && in_sub_channel / in_block == multiplexed_sub_channel(a, b, gap) / in_block;
+                }
+            }
+            if (used) {
+                shifts.push_back(std::make_pair(shift_ud, shift_lr));
+                rotation_indices.push_back(shift_ud * row_size + shift_lr);
             }
-
-            int output_idx = output_channel_index * shards_per_channel + shard_index;
-            output_shards[output_idx] = enc_sum;
         }
     }
 
-    boost::python::list res = pyOpenFHE::make_list(num_output_shards);
-    for(int s = 0 ; s < num_output_shards; ++s) {
-        res[s] = output_shards[s];
+    std::vector<std::vector<pyOpenFHE_CKKS::CKKSCiphertext>> all_ciphertext_rotations(num_input_shards);
+    #pragma omp parallel for
+    for (int f = 0; f < num_input_shards; f++) {
+        all_ciphertext_rotations[f] = CKKSHoistedRotationsVector(shards[f], rotation_indices);
     }
 
-    return res;
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> partial_convolutions(num_output_shards * num_input_shards * num_diagonals);
+
+    #pragma omp parallel for collapse(3)
+    for (int s = 0; s < num_output_shards; s++) {
+        for (int f = 0; f < num_input_shards; f++) {
+            for (int d = 0; d < num_diagonals; ++d) {
+                int idx = s * (num_diagonals * num_input_shards) + f * num_diagonals + d;
+                partial_convolutions[idx] = convolution_helper_multiplexed(
+                    all_ciphertext_rotations[f],
+                    shifts,
+                    filters,
+                    mtx_size,
+                    gap,
+                    d * diagonal_step,
+                    num_in_channels_per_shard,
+                    num_out_channels_per_shard,
+                    f,
+                    s,
+                    sigma
+                );
+            }
+        }
+    }
+
+    return parallelTreeSumGroups(partial_convolutions, num_output_shards, num_diagonals * num_input_shards);
 }
 
-boost::python::list pyOpenFHE_CKKS::conv2d(const boost::python::list &py_shards, const ndarray &npfilters, int mtx_size, const ndarray &permutation) {
+/*
+stride = 1 is the usual same-size convolution.
+stride = 2 gives the same result as conv2d followed by pool(conv=false), including the consolidated
+and duplicated output layout, but reduces the surviving outputs with a single fused mask level
+instead of the separate horizontal and vertical reductions.
+gap and multiplexed mean the same as for pool: gap describes the input, and multiplexed selects
+the multiplexed layout for the stride 2 output.
+groups > 1 is a grouped convolution (groups = channels is depthwise), with filters of shape
+(input channels / groups, output channels, k, k). Cross-group partials are skipped entirely.
+*/
+boost::python::list pyOpenFHE_CKKS::conv2d(const boost::python::list &py_shards, const ndarray &npfilters, int mtx_size, const ndarray &permutation, int stride, int gap, bool multiplexed, int groups) {
+    if (stride != 1 && stride != 2) {
+        throw std::runtime_error(fmt::format("conv2d stride = {} is not supported, must be 1 or 2", stride));
+    }
+    check_multiplexed_gap(gap);
+    if (gap > 1 && !multiplexed) {
+        throw std::runtime_error(fmt::format("a multiplexed input (gap = {}) can only be convolved with multiplexed = True", gap));
+    }
+    if (groups < 1) {
+        throw std::runtime_error(fmt::format("conv2d groups = {} is not supported, must be at least 1", groups));
+    }
+    if (groups > 1 && gap > 1) {
+        throw std::runtime_error("grouped convolutions are not supported in the multiplexed layout");
+    }
+
     // extract objects
     int num_input_shards = len(py_shards);
     std::vector<pyOpenFHE_CKKS::CKKSCiphertext> shards(num_input_shards);
@@ -370,10 +704,30 @@ boost::python::list pyOpenFHE_CKKS::conv2d(const boost::python::list &py_shards,
     int shard_size = shards[0].getBatchSize();
     int channel_size = mtx_size * mtx_size;
 
-    if (shard_size >= channel_size) {
-        return conv2d_image_sharded(shards, npfilters, mtx_size, permutation);
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> output_shards;
+    if ((gap > 1 || (multiplexed && stride == 2)) && shard_size < channel_size * gap * gap) {
+        throw std::runtime_error("the multiplexed layout needs image-sharded inputs");
+    }
+    if (gap > 1) {
+        output_shards = conv2d_multiplexed(shards, npfilters, mtx_size, gap, permutation);
+    } else if (shard_size >= channel_size && groups > 1) {
+        output_shards = conv2d_image_sharded_grouped(shards, npfilters, mtx_size, permutation, groups);
+    } else if (shard_size >= channel_size) {
+        output_shards = conv2d_image_sharded(shards, npfilters, mtx_size, permutation);
     } else {
         // A conv on a channel-sharded image won't have permuted channels, so ignore the permutation
-        return conv2d_channel_sharded(shards, npfilters, mtx_size);
+        output_shards = conv2d_channel_sharded(shards, npfilters, mtx_size, groups);
     }
-}
\ No newline at end of file
+
+    if (stride == 2) {
+        output_shards = pool_strided_downsample(output_shards, mtx_size, gap, multiplexed);
+    }
+
+    int num_output_shards = output_shards.size();
+    boost::python::list res = pyOpenFHE::make_list(num_output_shards);
+    for(int s = 0 ; s < num_output_shards; ++s) {
+        res[s] = output_shards[s];
+    }
+
+    return res;
+}
@@ -8,22 +8,121 @@
 #include "ckks/cnn/conv.hpp"
 #include "ckks/cnn/linear.hpp"
 #include "ckks/cnn/poly.hpp"
+#include "utils/reduce.hpp"
 #include <boost/python/scope.hpp>
 #include <omp.h>
+#include <cmath>
+#include <stdexcept>
+#include <fmt/format.h>
 
 using namespace pyOpenFHE;
 using namespace pyOpenFHE_CKKS;
 using namespace boost::python;
 using namespace boost::python::numpy;
 
+/*
+Baby-step giant-step evaluation of sum_i (shard << rotation(i)) * mask(i),
+where term i = k * num_baby_steps + j is rotated by k * giant_step + j * baby_step.
+
+Since
+    (shard << (k * giant_step + j * baby_step)) * m = ((shard << j * baby_step) * (m >> k * giant_step)) << k * giant_step
+the baby-step rotations are shared by every giant step, and the giant step
+rotation is applied once to the sum of its terms instead of to every term.
+The baby steps all come from the same source ciphertext, so they're hoisted.
+Masks are produced on demand so we never hold all of them at once.
+*/
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> pyOpenFHE_CKKS::rotate_mask_and_sum_bsgs(const std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int baby_step, int num_baby_steps, int giant_step, int num_terms, const std::function<std::vector<double>(int)>& mask) {
+    int num_shards = shards.size();
+    int num_giant_steps = (num_terms + num_baby_steps - 1) / num_baby_steps;
+
+    std::vector<int> baby_rotations(num_baby_steps);
+    for (int j = 0; j < num_baby_steps; ++j) {
+        baby_rotations[j] = j * baby_step;
+    }
+
+    std::vector<std::vector<pyOpenFHE_CKKS::CKKSCiphertext>> baby_steps(num_shards);
+    #pragma omp parallel for
+    for (int s = 0; s < num_shards; ++s) {
+        baby_steps[s] = CKKSHoistedRotationsVector(shards[s], baby_rotations);
+    }
+
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> giant_steps(num_shards * num_giant_steps);
+    #pragma omp parallel for collapse(2)
+    for (int s = 0; s < num_shards; ++s) {
+        for (int k = 0; k < num_giant_steps; ++k) {
+            int giant_rotation = k * giant_step;
+
+            auto ctxt = baby_steps[s][0] * rotateVector(mask(k * num_baby_steps), -giant_rotation);
+            for (int j = 1; j < num_baby_steps && k * num_baby_steps + j < num_terms; ++j) {
+                ctxt += baby_steps[s][j] * rotateVector(mask(k * num_baby_steps + j), -giant_rotation);
+            }
+            giant_steps[s * num_giant_steps + k] = ctxt << giant_rotation;
+        }
+    }
+
+    return parallelTreeSumGroups(giant_steps, num_shards, num_giant_steps);
+}
+
+/*
+sum_i (shard << i * step) * masks[i], with about sqrt(len(masks)) baby steps.
+This brings the rotation count from len(masks) down to about 2 * sqrt(len(masks)),
+with the same multiplicative depth as rotating and masking each term directly.
+*/
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> pyOpenFHE_CKKS::rotate_mask_and_sum(const std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int step, const std::vector<std::vector<double>>& masks) {
+    int num_terms = masks.size();
+    int num_baby_steps = (int)std::ceil(std::sqrt((double)num_terms));
+
+    return rotate_mask_and_sum_bsgs(shards, step, num_baby_steps, num_baby_steps * step, num_terms, [&masks](int i) { return masks[i]; });
+}
+
+void pyOpenFHE_CKKS::check_multiplexed_gap(int gap) {
+    if (gap < 1 || (gap & (gap - 1)) != 0) {
+        throw std::runtime_error(fmt::format("gap = {} is not supported, must be a power of 2", gap));
+    }
+}
+
+// interleaves the bits of the offsets, so each multiplexed pool appends two high bits to the index
+int pyOpenFHE_CKKS::multiplexed_sub_channel(int row_offset, int col_offset, int gap) {
+    int sub_channel = 0;
+    for (int bit = 0; (1 << bit) < gap; ++bit) {
+        sub_channel |= ((row_offset >> bit) & 1) << (2 * bit + 1);
+        sub_channel |= ((col_offset >> bit) & 1) << (2 * bit);
+    }
+    return sub_channel;
+}
+
+/*
+With no duplication this is just p + num_physical_channels * q.
+With fewer channels than physical channels, duplicates are adjacent physical channels exactly like the
+non-multiplexed layout, and otherwise the channels repeat every num_channels slots.
+Both are what multiplexed pooling of a duplicated shard produces.
+*/
+int pyOpenFHE_CKKS::multiplexed_channel_index(int physical_channel, int sub_channel, int num_physical_channels, int num_channels) {
+    if (num_channels <= num_physical_channels) {
+        return physical_channel / (num_physical_channels / num_channels);
+    }
+    return (physical_channel + num_physical_channels * sub_channel) % num_channels;
+}
+
 class boost_CNN {};
 
+BOOST_PYTHON_FUNCTION_OVERLOADS(conv2d_overloads, conv2d, 4, 8)
+BOOST_PYTHON_FUNCTION_OVERLOADS(linear_overloads, linear, 5, 6)
+BOOST_PYTHON_FUNCTION_OVERLOADS(pool_overloads, pool, 3, 5)
+BOOST_PYTHON_FUNCTION_OVERLOADS(fhe_relu_overloads, fhe_relu, 2, 3)
+
 void pyOpenFHE_CKKS::export_he_cnn_functions_boost() {
-    def("conv2d", conv2d);
-    def("linear", linear);
-    def("pool", pool);
+    def("conv2d", conv2d,
+        conv2d_overloads((arg("shards"), arg("filters"), arg("mtx_size"), arg("permutation"), arg("stride") = 1, arg("gap") = 1, arg("multiplexed") = false, arg("groups") = 1)));
+    def("linear", linear,
+        linear_overloads((arg("shards"), arg("weights"), arg("mtx_size"), arg("permutation"), arg("pool_factor"), arg("gap") = 1)));
+    def("pool", pool,
+        pool_overloads((arg("shards"), arg("mtx_size"), arg("conv"), arg("gap") = 1, arg("multiplexed") = false)));
     def("upsample", upsample);
     def("fhe_gelu", fhe_gelu);
+    def("fhe_sign", fhe_sign, (arg("shards"), arg("alpha")));
+    def("fhe_relu", fhe_relu,
+        fhe_relu_overloads((arg("shards"), arg("alpha"), arg("bound") = 1.0)));
     def("omp_set_num_threads", omp_set_num_threads);
     def("omp_set_nested", omp_set_nested);
     def("omp_set_dynamic", omp_set_dynamic);
@@ -2,6 +2,8 @@
 
 #include "ckks/CKKS_ciphertext_extension.hpp"
 #include "ckks/cnn/linear.hpp"
+#include "ckks/cnn/he_cnn.hpp"
+#include "utils/reduce.hpp"
 
 #include <stdexcept>
 
@@ -11,7 +13,10 @@
 #include <omp.h>
 #include <cstdlib>
 
-pyOpenFHE_CKKS::CKKSCiphertext pyOpenFHE_CKKS::linear(const boost::python::list &py_shards, const ndarray &npweights, const int mtx_size, const ndarray &permutation, const int pool_factor) {
+// gap is the interleaving of a multiplexed input, see he_cnn.hpp. With gap = 1 this is the usual layout.
+pyOpenFHE_CKKS::CKKSCiphertext pyOpenFHE_CKKS::linear(const boost::python::list &py_shards, const ndarray &npweights, const int mtx_size, const ndarray &permutation, const int pool_factor, const int gap) {
+    check_multiplexed_gap(gap);
+
     auto sigma = numpyListToCppLongIntVector(permutation);
     auto weights = numpyArrayToCppArray2D(npweights);
 
@@ -29,12 +34,15 @@ pyOpenFHE_CKKS::CKKSCiphertext pyOpenFHE_CKKS::linear(const boost::python::list
     int num_outputs = weights.shape()[0];
     int num_inputs  = weights.shape()[1];
     int shard_size = first_shard.getBatchSize();
-    int channel_size = mtx_size * mtx_size;
+    int row_size = mtx_size * gap;
+    int channel_size = row_size * row_size;
     int num_physical_channels_per_shard = shard_size / channel_size;
+    int num_channels_per_shard = num_physical_channels_per_shard * gap * gap;
 
     int duplication_factor = 1;
     if (num_shards == 1) {
         duplication_factor = shard_size / num_inputs;
+        num_channels_per_shard /= duplication_factor;
     }
 
     std::vector<pyOpenFHE_CKKS::CKKSCiphertext> partial_output(num_outputs * num_shards);
@@ -44,10 +52,13 @@ pyOpenFHE_CKKS::CKKSCiphertext pyOpenFHE_CKKS::linear(const boost::python::list
         for (int s = 0; s < num_shards; s++) {
             std::vector<double> v(shard_size, 0.0);
             for (int i = 0; i < shard_size; ++i) {
-                int physical_channel_idx = i / channel_size + s * num_physical_channels_per_shard;
-                int logical_channel_idx = sigma[physical_channel_idx / duplication_factor];
-                int channel_offset = i % channel_size;
-                int idx = logical_channel_idx * channel_size + channel_offset;
+                int row = (i % channel_size) / row_size;
+                int col = i % row_size;
+                int sub_channel = multiplexed_sub_channel(row % gap, col % gap, gap);
+                int channel_idx = s * num_channels_per_shard + multiplexed_channel_index(i / channel_size, sub_channel, num_physical_channels_per_shard, num_channels_per_shard);
+                int logical_channel_idx = sigma[channel_idx];
+                int channel_offset = (row / gap) * mtx_size + col / gap;
+                int idx = logical_channel_idx * mtx_size * mtx_size + channel_offset;
 
                 v[i] = weights[r][idx];
             }
@@ -74,10 +85,5 @@ pyOpenFHE_CKKS::CKKSCiphertext pyOpenFHE_CKKS::linear(const boost::python::list
         }
     }
 
-    auto enc_sum = partial_output[0];
-    for(int r = 1; r < num_outputs * num_shards; ++r) {
-        enc_sum += partial_output[r];
-    }
-
-    return enc_sum;
+    return parallelTreeSum(partial_output);
 }
\ No newline at end of file
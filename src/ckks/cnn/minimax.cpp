@@ -0,0 +1,406 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include "ckks/cnn/minimax.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <fmt/format.h>
+
+/*
+EvalChebyshevSeries uses Paterson-Stockmeyer, whose depth only depends on the degree.
+These are OpenFHE's largest degrees for each depth, starting at depth 3,
+and it has no depth for anything past the last one.
+*/
+int pyOpenFHE_CKKS::chebyshevDepthByDegree(int degree) {
+    static const int max_degree_by_depth[] = {5, 13, 27, 59, 119, 247, 495, 1007, 2031};
+
+    const int largest_degree = max_degree_by_depth[sizeof(max_degree_by_depth) / sizeof(max_degree_by_depth[0]) - 1];
+    if (degree > largest_degree) {
+        throw std::runtime_error(fmt::format("Chebyshev series degree = {} is too large, must be at most {}", degree, largest_degree));
+    }
+
+    int depth = 3;
+    for (int max_degree : max_degree_by_depth) {
+        if (degree <= max_degree) {
+            break;
+        }
+        depth++;
+    }
+    return depth;
+}
+
+int pyOpenFHE_CKKS::compositeDepth(const std::vector<std::vector<double>> &stages) {
+    int depth = 0;
+    for (auto &stage : stages) {
+        depth += chebyshevDepthByDegree(stage.size() - 1);
+    }
+    return depth;
+}
+
+// sum_j a[j] T_{2j+1}(x), using the three term recurrence for T_n
+double evalOddChebyshev(const std::vector<double> &a, double x) {
+    double t_prev = 1.0; // T_0
+    double t_cur = x;    // T_1
+    double res = 0.0;
+    for (int n = 1; n < 2 * (int)a.size(); n++) {
+        if (n % 2 == 1) {
+            res += a[n / 2] * t_cur;
+        }
+        double t_next = 2 * x * t_cur - t_prev;
+        t_prev = t_cur;
+        t_cur = t_next;
+    }
+    return res;
+}
+
+// T_1(x), T_3(x), ..., T_{2k-1}(x)
+std::vector<double> oddChebyshevBasis(int k, double x) {
+    std::vector<double> basis(k);
+    double t_prev = 1.0;
+    double t_cur = x;
+    for (int n = 1; n < 2 * k; n++) {
+        if (n % 2 == 1) {
+            basis[n / 2] = t_cur;
+        }
+        double t_next = 2 * x * t_cur - t_prev;
+        t_prev = t_cur;
+        t_cur = t_next;
+    }
+    return basis;
+}
+
+// gaussian elimination with partial pivoting, A is n x (n + 1) augmented
+std::vector<double> solveLinearSystem(std::vector<std::vector<double>> A) {
+    int n = A.size();
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++) {
+            if (std::abs(A[row][col]) > std::abs(A[pivot][col])) {
+                pivot = row;
+            }
+        }
+        std::swap(A[col], A[pivot]);
+        for (int row = col + 1; row < n; row++) {
+            double factor = A[row][col] / A[col][col];
+            for (int k = col; k <= n; k++) {
+                A[row][k] -= factor * A[col][k];
+            }
+        }
+    }
+
+    std::vector<double> x(n);
+    for (int row = n - 1; row >= 0; row--) {
+        double sum = A[row][n];
+        for (int k = row + 1; k < n; k++) {
+            sum -= A[row][k] * x[k];
+        }
+        x[row] = sum / A[row][row];
+    }
+    return x;
+}
+
+/*
+Remez exchange for the odd polynomial of the given degree closest to 1 on [lower, 1],
+in the basis T_1, T_3, ... so high degrees stay well conditioned.
+Returns the coefficients and the maximum error, both measured on a grid that is
+geometric near lower (where the error oscillates fastest) and uniform elsewhere.
+*/
+std::pair<std::vector<double>, double> remezOddSign(int degree, double lower) {
+    int k = (degree + 1) / 2; // number of odd basis polynomials
+    int num_refs = k + 1;
+
+    std::vector<double> grid;
+    const int num_grid_points = 200 * k + 2000;
+    for (int i = 0; i <= num_grid_points; i++) {
+        double t = (double)i / num_grid_points;
+        grid.push_back(lower * std::pow(1.0 / lower, t));
+        grid.push_back(lower + (1.0 - lower) * t);
+        grid.push_back((1.0 + lower) / 2 - (1.0 - lower) / 2 * std::cos(M_PI * t));
+    }
+    std::sort(grid.begin(), grid.end());
+    grid.erase(std::unique(grid.begin(), grid.end()), grid.end());
+
+    // start from the Chebyshev nodes of [lower, 1]
+    std::vector<double> refs(num_refs);
+    for (int i = 0; i < num_refs; i++) {
+        refs[i] = (1.0 + lower) / 2 - (1.0 - lower) / 2 * std::cos(M_PI * i / k);
+    }
+
+    std::vector<double> a(k);
+    std::vector<double> err(grid.size());
+    // the exchange isn't monotone on badly conditioned domains, so keep the best iterate
+    std::vector<double> best_a(k, 0.0);
+    double best_err = 1.0;
+    for (int iter = 0; iter < 100; iter++) {
+        // solve p(refs[i]) + (-1)^i h = 1
+        std::vector<std::vector<double>> A(num_refs, std::vector<double>(num_refs + 1));
+        for (int i = 0; i < num_refs; i++) {
+            auto basis = oddChebyshevBasis(k, refs[i]);
+            for (int j = 0; j < k; j++) {
+                A[i][j] = basis[j];
+            }
+            A[i][k] = (i % 2 == 0) ? 1.0 : -1.0;
+            A[i][k + 1] = 1.0;
+        }
+        auto solution = solveLinearSystem(A);
+        std::copy(solution.begin(), solution.begin() + k, a.begin());
+        double level = std::abs(solution[k]);
+
+        for (size_t i = 0; i < grid.size(); i++) {
+            err[i] = evalOddChebyshev(a, grid[i]) - 1.0;
+        }
+
+        // the largest error in each run of constant sign, which alternate by construction
+        std::vector<int> extrema;
+        for (size_t i = 0; i < grid.size(); i++) {
+            if (!extrema.empty() && (err[i] >= 0) == (err[extrema.back()] >= 0)) {
+                if (std::abs(err[i]) > std::abs(err[extrema.back()])) {
+                    extrema.back() = i;
+                }
+            } else {
+                extrema.push_back(i);
+            }
+        }
+
+        // the grid can straddle the sharpest peaks near lower, so polish every extremum between its neighbours
+        std::vector<double> extrema_x(extrema.size());
+        double max_err = 0.0;
+        for (size_t e = 0; e < extrema.size(); e++) {
+            int i = extrema[e];
+            double lo = grid[std::max(i - 1, 0)];
+            double hi = grid[std::min(i + 1, (int)grid.size() - 1)];
+            for (int step = 0; step < 100; step++) {
+                double m1 = lo + (hi - lo) / 3;
+                double m2 = hi - (hi - lo) / 3;
+                if (std::abs(evalOddChebyshev(a, m1) - 1.0) < std::abs(evalOddChebyshev(a, m2) - 1.0)) {
+                    lo = m1;
+                } else {
+                    hi = m2;
+                }
+            }
+            extrema_x[e] = (lo + hi) / 2;
+            double e_err = std::abs(evalOddChebyshev(a, extrema_x[e]) - 1.0);
+            // written so that a NaN from a degenerate system propagates
+            if (!(e_err <= max_err)) {
+                max_err = e_err;
+            }
+        }
+
+        // a degenerate system, which we only get on domains so narrow that a lower degree will do
+        if (!std::isfinite(max_err)) {
+            break;
+        }
+        if (max_err < best_err) {
+            best_err = max_err;
+            best_a = a;
+        }
+        if ((int)extrema.size() < num_refs) {
+            break;
+        }
+        // drop the smaller end until we're back to num_refs alternating points
+        while ((int)extrema_x.size() > num_refs) {
+            if (std::abs(evalOddChebyshev(a, extrema_x.front()) - 1.0) < std::abs(evalOddChebyshev(a, extrema_x.back()) - 1.0)) {
+                extrema_x.erase(extrema_x.begin());
+            } else {
+                extrema_x.pop_back();
+            }
+        }
+        refs = extrema_x;
+
+        if (max_err - level <= 1e-9 * max_err) {
+            break;
+        }
+    }
+
+    return std::make_pair(best_a, best_err);
+}
+
+// odd coefficients sum_j a[j] T_{2j+1} in EvalChebyshevSeries form, scaled by scale
+std::vector<double> toSeriesCoefficients(const std::vector<double> &a, double scale) {
+    std::vector<double> coefficients(2 * a.size(), 0.0);
+    for (size_t j = 0; j < a.size(); j++) {
+        coefficients[2 * j + 1] = a[j] * scale;
+    }
+    return coefficients;
+}
+
+/*
+Every stage but the last maps [lower, 1] into [1 - E, 1 + E] and is then divided by 1 + E,
+so the next stage sees [(1 - E) / (1 + E), 1] and still gets to use all of [-1, 1].
+The last stage is left alone, so the composite is within E of sign(x).
+Each stage uses the largest degree for its depth, and we search stage sequences
+by increasing total depth (iterative deepening), so the first hit has the least depth.
+*/
+std::vector<std::vector<double>> pyOpenFHE_CKKS::compositeSignChebyshev(int alpha, double epsilon) {
+    if (alpha < 1 || alpha > 30) {
+        throw std::runtime_error(fmt::format("sign precision alpha = {} bits is not supported, must be between 1 and 30", alpha));
+    }
+    if (epsilon <= 0.0 || epsilon >= 1.0) {
+        throw std::runtime_error(fmt::format("sign input gap epsilon = {} must be strictly between 0 and 1", epsilon));
+    }
+
+    const int stage_degrees[] = {59, 27, 13, 5};
+    const double target = std::pow(2.0, -alpha);
+
+    std::map<std::pair<int, double>, std::pair<std::vector<double>, double>> remez_cache;
+    auto remez = [&](int degree, double lower) {
+        auto key = std::make_pair(degree, lower);
+        auto it = remez_cache.find(key);
+        if (it == remez_cache.end()) {
+            it = remez_cache.emplace(key, remezOddSign(degree, lower)).first;
+        }
+        return it->second;
+    };
+
+    std::vector<std::vector<double>> stages;
+    std::function<bool(double, int)> search = [&](double lower, int depth_left) {
+        for (int degree : stage_degrees) {
+            int depth = chebyshevDepthByDegree(degree);
+            if (depth > depth_left) {
+                continue;
+            }
+
+            auto approx = remez(degree, lower);
+            double error = approx.second;
+            // no better than the zero polynomial, so this stage can't make progress
+            if (error >= 1.0) {
+                continue;
+            }
+            if (error <= target) {
+                stages.push_back(toSeriesCoefficients(approx.first, 1.0));
+                return true;
+            }
+
+            stages.push_back(toSeriesCoefficients(approx.first, 1.0 / (1.0 + error)));
+            if (search((1.0 - error) / (1.0 + error), depth_left - depth)) {
+                return true;
+            }
+            stages.pop_back();
+        }
+        return false;
+    };
+
+    for (int max_depth = chebyshevDepthByDegree(5); max_depth <= 100; max_depth++) {
+        if (search(epsilon, max_depth)) {
+            return stages;
+        }
+    }
+
+    throw std::runtime_error(fmt::format("Could not find a composite sign approximation for alpha = {}, epsilon = {}", alpha, epsilon));
+}
+
+/*
+What compositeSignChebyshev(alpha, 2^-alpha) designs for the alphas we support, as the odd
+coefficients of each stage (of T_1, T_3, ...). The search takes from a tenth of a second
+at alpha = 8 to seconds at 16 and close to a minute past 20, so it's run offline and the
+results live here. Regenerate them if remezOddSign or the search changes.
+*/
+const std::map<int, std::vector<std::vector<double>>> precomputed_composite_signs = {
+    {8, {
+        {
+            0.75386143760261948, -0.2513541593769868, 0.15089311868934108,
+            -0.10786755192015136, 0.08398749295564481, -0.068810324092146699,
+            0.058319742468733712, -0.050641554265569759, 0.044783615050471022,
+            -0.04017159814234645, 0.036450039071830233, -0.0333871838366133,
+            0.030825510941579967, -0.028654244651995481, 0.026793243158231433,
+            -0.025183124763076558, 0.02377898584676677, -0.022546274117444309,
+            0.021458001883368719, -0.020492818605378427, 0.019633649654941313,
+            -0.018866717331276706, 0.018180825682102504, -0.017566831109554128,
+            0.017017246349756088, -0.016525942024798852, 0.016087920976589648,
+            -0.015699148063495962, 0.01535642328496435, -0.41553644044335353
+        },
+        {
+            1.2696962762649007, -0.41388006797916649, 0.23741014975467226,
+            -0.15840836641166234, 0.11235367618303621, -0.08172985350844908,
+            0.059840072251358276, -0.043568048485451039, 0.031249348830121454,
+            -0.021889141781780388, 0.014830053638172717, -0.0095970296179373592,
+            0.0058205414702970117, -0.0042801144313992833
+        }
+    }},
+    {12, {
+        {
+            0.64435873072412431, -0.21487620189820711, 0.12903389770322965,
+            -0.092283379527980686, 0.071897172897189721, -0.058949712449554631,
+            0.050008184865351767, -0.04347069838741198, 0.038489274753068681,
+            -0.034573057632414, 0.031418259992086021, -0.028826835489580309,
+            0.026664188553901874, -0.024835680999941045, 0.02327286113064678,
+            -0.021925024690176192, 0.020753845854365908, -0.019729850456358444,
+            0.018830034627049855, -0.018036217958096526, 0.017333880700317519,
+            -0.016711327788589973, 0.016159078463392072, -0.015669414826385467,
+            0.015236044558001182, -0.014853847228837603, 0.014518683054045719,
+            -0.01422724933576699, 0.013976974280338422, -0.50087923433713122
+        },
+        {
+            0.95005326214318886, -0.31664471668410993, 0.18993934104241925,
+            -0.1356203564251923, 0.10543043247082773, -0.086208554744463053,
+            0.07289286145405792, -0.063121211501986116, 0.055643116951473295,
+            -0.049734666199547556, 0.044947777464421482, -0.040990277268610459,
+            0.037663542020397331, -0.034827855275761425, 0.032382100825772933,
+            -0.030251317513829305, 0.02837878067182819, -0.026720799723394452,
+            0.025243204440844463, -0.023918913937355388, 0.022726218989572892,
+            -0.021647545811365267, 0.020668551930325827, -0.019777455767557607,
+            0.018964533780301277, -0.018221739939791582, 0.017542416171033737,
+            -0.016921071764607248, 0.01635321626666637, -0.26185928340167131
+        },
+        {
+            1.2527558676353916, -0.3663006667771756, 0.16788731445830932,
+            -0.078439963491594294, 0.033057619615465939, -0.011331093915808329,
+            0.0026029926998352316
+        }
+    }},
+    {16, {
+        {
+            0.63713670480136497, -0.21246975558433609, 0.12759110543032418,
+            -0.091253967247337045, 0.07109771712962519, -0.058296840198160366,
+            0.049457004363352375, -0.04299427601247683, 0.038070184342816712,
+            -0.034199377525821854, 0.031081476238098017, -0.028520656699645045,
+            0.026383834807836421, -0.024577436112937442, 0.023033779302210768,
+            -0.02170273177163964, 0.020546400825078984, -0.019535646461820246,
+            0.018647726743542998, -0.017864669454837254, 0.017172122378594282,
+            -0.01655852674051253, 0.016014513728602502, -0.015532458173660314,
+            0.015106145122072069, -0.014730519077347267, 0.014401494998937997,
+            -0.014115816471719382, 0.01387095085194435, -0.50649996362737704
+        },
+        {
+            0.66044147878803139, -0.22023487472598585, 0.13224640768530449,
+            -0.094575140030150703, 0.073676651901489129, -0.060402573793026507,
+            0.051234397755628075, -0.044530240573982506, 0.039420951480329265,
+            -0.035403415881764926, 0.032166257849393552, -0.029506481357109041,
+            0.02728612468387525, -0.025408180543206264, 0.02380248138774366,
+            -0.022417049652492256, 0.021212594663035083, -0.020158897757077826,
+            0.019232371403861696, -0.018414371170927146, 0.01769000379674723,
+            -0.017047270233894612, 0.016476439903553113, -0.015969587831620786,
+            0.015520248773163931, -0.015123156989430018, 0.014774049993230823,
+            -0.01446952113265247, 0.014206910434098653, -0.48835918708832138
+        },
+        {
+            1.0363367838201261, -0.34479944489360465, 0.20610825917072062,
+            -0.14640087151819112, 0.11302836319600737, -0.091634172658055901,
+            0.076698727179530732, -0.065648488102164615, 0.057123467482967212,
+            -0.050339142743365782, 0.04481326147840458, -0.040235563009137693,
+            0.036400585293610052, -0.20319641194005847
+        },
+        {
+            1.2462660650975699, -0.34943345641206974, 0.14693921139298943,
+            -0.05995375927950565, 0.020791644813154167, -0.0054112356153998677,
+            0.0008153756432830615
+        }
+    }}
+};
+
+std::vector<std::vector<double>> pyOpenFHE_CKKS::compositeSignStages(int alpha) {
+    auto it = precomputed_composite_signs.find(alpha);
+    if (it == precomputed_composite_signs.end()) {
+        throw std::runtime_error(fmt::format("sign precision alpha = {} bits is not supported, must be 8, 12 or 16", alpha));
+    }
+
+    std::vector<std::vector<double>> stages;
+    for (auto &odd_coefficients : it->second) {
+        stages.push_back(toSeriesCoefficients(odd_coefficients, 1.0));
+    }
+    return stages;
+}
@@ -2,6 +2,7 @@
 
 #include "ckks/CKKS_ciphertext_extension.hpp"
 #include "ckks/cnn/poly.hpp"
+#include "ckks/cnn/minimax.hpp"
 
 #include <stdexcept>
 #include <fmt/format.h>
@@ -11,6 +12,10 @@
 #include <boost/python/scope.hpp>
 #include <omp.h>
 #include <cstdlib>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
 
 #include "math/chebyshev.h"
 
@@ -32,40 +37,243 @@ double cpp_relu(double x) {
     return x;
 }
 
-boost::python::list pyOpenFHE_CKKS::fhe_gelu(const boost::python::list &py_shards, int degree, double bound) {
+double cpp_sigmoid(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+double cpp_silu(double x) {
+    return x * cpp_sigmoid(x);
+}
+
+double cpp_tanh(double x) {
+    return std::tanh(x);
+}
+
+// activations that can be passed to activation by name
+const std::map<std::string, std::function<double(double)>> named_activations = {
+    {"gelu", cpp_gelu},
+    {"relu", cpp_relu},
+    {"silu", cpp_silu},
+    {"sigmoid", cpp_sigmoid},
+    {"tanh", cpp_tanh},
+};
+
+/*
+Coefficients are cached by (name, degree, lower, upper).
+Callables are only cached under a key the caller gives us, since we can't tell
+two lambdas apart, and a cache that holds on to every one of them never stops growing.
+*/
+std::mutex coefficient_cache_mutex;
+std::map<std::tuple<std::string, int, double, double>, std::vector<double>> coefficient_cache;
+
+std::vector<double> cachedChebyshevCoefficients(const std::string &name, const std::function<double(double)> &fn, int degree, double lower, double upper) {
+    auto key = std::make_tuple(name, degree, lower, upper);
+    {
+        std::lock_guard<std::mutex> lock(coefficient_cache_mutex);
+        auto it = coefficient_cache.find(key);
+        if (it != coefficient_cache.end()) {
+            return it->second;
+        }
+    }
 
+    // fn may call back into python, which can hand the GIL to a thread that then waits on the lock,
+    // so it must not be held here. Two threads may both compute the same entry, which is harmless.
+    auto coefficients = EvalChebyshevCoefficients(fn, lower, upper, degree);
+
+    std::lock_guard<std::mutex> lock(coefficient_cache_mutex);
+    coefficient_cache.emplace(key, coefficients);
+    return coefficients;
+}
+
+std::vector<double> pyOpenFHE_CKKS::activationCoefficients(const boost::python::object &fn, int degree, double lower, double upper, const boost::python::object &cacheKey) {
+    if (degree < 1) {
+        throw std::runtime_error(fmt::format("Chebyshev series degree = {} must be at least 1", degree));
+    }
+    // throws for degrees OpenFHE can't evaluate, before we spend time on the coefficients
+    chebyshevDepthByDegree(degree);
+    if (lower >= upper) {
+        throw std::runtime_error(fmt::format("Empty interval [{}, {}] for the Chebyshev series", lower, upper));
+    }
+
+    extract<std::string> get_name(fn);
+    if (get_name.check()) {
+        std::string name = get_name();
+        auto it = named_activations.find(name);
+        if (it == named_activations.end()) {
+            throw std::runtime_error(fmt::format("Unknown activation '{}', expected one of gelu, relu, silu, sigmoid, tanh or a callable", name));
+        }
+        return cachedChebyshevCoefficients(name, it->second, degree, lower, upper);
+    }
+
+    if (!PyCallable_Check(fn.ptr())) {
+        throw std::runtime_error("activation must be the name of an activation or a callable");
+    }
+
+    // EvalChebyshevCoefficients calls back into python, so this all happens with the GIL held
+    auto call = [fn](double x) -> double { return extract<double>(fn(x)); };
+    if (cacheKey.is_none()) {
+        return EvalChebyshevCoefficients(call, lower, upper, degree);
+    }
+
+    extract<std::string> get_key(cacheKey);
+    if (!get_key.check()) {
+        throw std::runtime_error("cacheKey must be a string or None");
+    }
+    // prefixed, so a key can't collide with a named activation
+    return cachedChebyshevCoefficients("callable:" + get_key(), call, degree, lower, upper);
+}
+
+/*
+Trailing coefficients that are zero don't count towards the degree,
+and anything other than [-1, 1] costs one more level to map the input onto [-1, 1].
+*/
+int pyOpenFHE_CKKS::chebyshevSeriesDepth(const std::vector<double> &coefficients, double lower, double upper) {
+    int degree = coefficients.size() - 1;
+    while (degree > 0 && coefficients[degree] == 0.0) {
+        degree--;
+    }
+
+    int depth = chebyshevDepthByDegree(degree);
+    if (lower != -1.0 || upper != 1.0) {
+        depth++;
+    }
+    return depth;
+}
+
+void pyOpenFHE_CKKS::evalChebyshevShards(std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &shards, const std::vector<double> &coefficients, double lower, double upper) {
+    int num_input_shards = shards.size();
+    int depth = chebyshevSeriesDepth(coefficients, lower, upper);
+    int level = shards[0].getTowersRemaining() - 2;
+    if (level < depth) {
+        throw std::runtime_error(fmt::format("Insufficient number of towers remaining = {} to evaluate this Chebyshev series of degree = {}, which needs depth = {}", level + 2, coefficients.size() - 1, depth));
+    }
+
+    // the first error, since we can't throw from inside the parallel loop
+    std::string error;
+    #pragma omp parallel for
+    for(int i = 0 ; i < num_input_shards; ++i) {
+        try {
+            auto cc = shards[i].cipher->GetCryptoContext();
+            shards[i].cipher = cc->EvalChebyshevSeries(shards[i].cipher, coefficients, lower, upper);
+        } catch (const std::exception &e) {
+            #pragma omp critical
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> extractShards(const boost::python::list &py_shards) {
     int num_input_shards = len(py_shards);
     std::vector<pyOpenFHE_CKKS::CKKSCiphertext> shards(num_input_shards);
     for(int i = 0 ; i < num_input_shards; ++i) {
         shards[i] = extract<pyOpenFHE_CKKS::CKKSCiphertext>(py_shards[i]);
     }
+    return shards;
+}
+
+boost::python::list evalChebyshevList(const boost::python::list &py_shards, const std::vector<double> &coefficients, double lower, double upper) {
+    auto shards = extractShards(py_shards);
+    int num_input_shards = shards.size();
+
+    {
+        pyOpenFHE::ScopedGILRelease release;
+        pyOpenFHE_CKKS::evalChebyshevShards(shards, coefficients, lower, upper);
+    }
+
+    boost::python::list res = pyOpenFHE::make_list(num_input_shards);
+    for(int i = 0 ; i < num_input_shards; ++i) {
+        res[i] = shards[i];
+    }
+
+    return res;
+}
+
+/*
+fn is one of "gelu", "relu", "silu", "sigmoid", "tanh", or any callable from float to float,
+and is approximated over [-bound, bound] by a Chebyshev series of the given degree.
+bound = 1 saves the level that mapping the input onto [-1, 1] would otherwise cost.
+The coefficients of a callable are only reused across calls if cacheKey names it.
+*/
+boost::python::list pyOpenFHE_CKKS::activation(const boost::python::list &py_shards, const boost::python::object &fn, int degree, double bound, const boost::python::object &cacheKey) {
+    auto coefficients = activationCoefficients(fn, degree, -bound, bound, cacheKey);
+    return evalChebyshevList(py_shards, coefficients, -bound, bound);
+}
+
+// inputs are expected to already be scaled down by bound, i.e. this computes gelu(bound * x) over [-1, 1]
+boost::python::list pyOpenFHE_CKKS::fhe_gelu(const boost::python::list &py_shards, int degree, double bound) {
+    std::vector<double> coefficients = cachedChebyshevCoefficients(fmt::format("gelu_scaled({})", bound), [bound](double x) -> double { return cpp_gelu_scaled(x, bound); }, degree, -1.0, 1.0);
+    return evalChebyshevList(py_shards, coefficients, -1.0, 1.0);
+}
 
+void checkCompositeDepth(const std::vector<pyOpenFHE_CKKS::CKKSCiphertext> &shards, int depth, int alpha) {
     int level = shards[0].getTowersRemaining() - 2;
-    if(
-        (level <= 2) || 
-        ((degree <= 5) && (level < 3)) || 
-        ((degree <= 13) && (degree >= 6) && (level < 4)) || 
-        ((degree <= 27) && (degree >= 14) && (level < 5)) || 
-        ((degree <= 59) && (degree >= 28) && (level < 6)) ||
-        ((degree <= 119) && (degree >= 60) && (level < 7)) ||
-        ((degree <= 200) && (degree >= 120) && (level < 8))
-        ) {
-        throw std::runtime_error(fmt::format("Insufficient number of towers remaining = {} to evaluate this Chebyshev series of degree = {}", level + 2, degree));
+    if (level < depth) {
+        throw std::runtime_error(fmt::format("Insufficient number of towers remaining = {} for a composite sign with alpha = {} bits, which needs depth = {}", level + 2, alpha, depth));
     }
+}
 
-    std::vector<double> coefficients = EvalChebyshevCoefficients([bound](double x) -> double { return cpp_gelu_scaled(x, bound); }, -1, 1, degree);
+/*
+Approximates sign(x) to within 2^-alpha for 2^-alpha <= |x| <= 1 by composing low degree odd
+minimax polynomials, which takes far less depth than a single Chebyshev series of similar accuracy.
+alpha is 8, 12 or 16, whose polynomials are precomputed.
+*/
+boost::python::list pyOpenFHE_CKKS::fhe_sign(const boost::python::list &py_shards, int alpha) {
+    auto stages = compositeSignStages(alpha);
+    auto shards = extractShards(py_shards);
+    checkCompositeDepth(shards, compositeDepth(stages), alpha);
 
-    #pragma omp parallel for
-    for(int i = 0 ; i < num_input_shards; ++i) {
-        auto cc = shards[i].cipher->GetCryptoContext();
-        shards[i].cipher = cc->EvalChebyshevSeries(shards[i].cipher, coefficients, -1.0, 1.0);
+    {
+        pyOpenFHE::ScopedGILRelease release;
+        for (auto &stage : stages) {
+            evalChebyshevShards(shards, stage, -1.0, 1.0);
+        }
+    }
+
+    boost::python::list res = pyOpenFHE::make_list(shards.size());
+    for(size_t i = 0 ; i < shards.size(); ++i) {
+        res[i] = shards[i];
+    }
+    return res;
+}
+
+/*
+relu(bound * x) = bound * x * (1 + sign(x)) / 2 over [-1, 1], scaled like fhe_gelu.
+The affine map is folded into the last stage, so this costs one level more than fhe_sign.
+*/
+boost::python::list pyOpenFHE_CKKS::fhe_relu(const boost::python::list &py_shards, int alpha, double bound) {
+    auto stages = compositeSignStages(alpha);
+    auto shards = extractShards(py_shards);
+    checkCompositeDepth(shards, compositeDepth(stages) + 1, alpha);
+
+    // EvalChebyshevSeries halves the constant coefficient
+    auto &last = stages.back();
+    for (auto &c : last) {
+        c *= bound / 2;
+    }
+    last[0] = bound;
+
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> inputs = shards;
+    int num_input_shards = shards.size();
+    {
+        pyOpenFHE::ScopedGILRelease release;
+        for (auto &stage : stages) {
+            evalChebyshevShards(shards, stage, -1.0, 1.0);
+        }
+
+        #pragma omp parallel for
+        for(int i = 0 ; i < num_input_shards; ++i) {
+            shards[i] *= inputs[i];
+        }
     }
 
     boost::python::list res = pyOpenFHE::make_list(num_input_shards);
     for(int i = 0 ; i < num_input_shards; ++i) {
         res[i] = shards[i];
     }
-
     return res;
-
-}
\ No newline at end of file
+}
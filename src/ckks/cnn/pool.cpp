@@ -2,6 +2,11 @@
 
 #include "ckks/cnn/pool.hpp"
 #include "ckks/CKKS_ciphertext_extension.hpp"
+#include "ckks/cnn/he_cnn.hpp"
+#include "utils/reduce.hpp"
+
+#include <stdexcept>
+#include <fmt/format.h>
 
 using namespace pyOpenFHE;
 using namespace pyOpenFHE_CKKS;
@@ -13,11 +18,12 @@ using namespace boost::python::numpy;
 * The masking and dividing by 4 is accomplished by the downsample masks later,
 * so we can get away with a very simple convolution here.
 */ 
-void pool_pre_convolution(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int num_cols) {
+void pool_pre_convolution(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int num_cols, int gap = 1) {
     int num_input_shards = shards.size();
 
+    // in a multiplexed layout neighbouring pixels are gap slots apart
     std::vector<pyOpenFHE_CKKS::CKKSCiphertext> shifts(num_input_shards * 4);
-    int shift_vals[] = {0, 1, num_cols, num_cols + 1};
+    int shift_vals[] = {0, gap, gap * num_cols, gap * (num_cols + 1)};
 
     #pragma omp parallel for collapse(2)
     for (int i = 0 ; i < num_input_shards; ++i) {
@@ -26,13 +32,7 @@ void pool_pre_convolution(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, i
         }
     }
 
-    #pragma omp parallel for
-    for (int i = 0; i < num_input_shards; ++i) {
-        shards[i] = shifts[i * 4];
-        for (int j = 1; j < 4; ++j) {
-            shards[i] += shifts[i * 4 + j];
-        }
-    }
+    shards = parallelTreeSumGroups(shifts, num_input_shards, 4);
 }
 
 void pool_horizontal_reduce(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int num_rows, int num_cols, int num_physical_channels_per_shard, double fill_value) {
@@ -52,23 +52,8 @@ void pool_horizontal_reduce(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards,
     	}
     }
 
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> horizontal_reductions(half_num_cols * num_input_shards);
-    #pragma omp parallel for collapse(2)
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        for (int i = 0 ; i < half_num_cols; ++i) {
-            // if performed sequentially, we could have a loop with `shards[s] <<= 1`
-            horizontal_reductions[i + s * half_num_cols] = (shards[s] << i) * horizontal_masks[i];
-        }
-    }
-
-    #pragma omp parallel for
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        auto ctxt = horizontal_reductions[s * half_num_cols];
-        for (int i = 1 ; i < half_num_cols; ++i) {
-            ctxt += horizontal_reductions[i + s * half_num_cols];
-        }
-        shards[s] = ctxt;
-    }
+    // sum of (shards[s] << i) * horizontal_masks[i]
+    shards = rotate_mask_and_sum(shards, 1, horizontal_masks);
 }
 
 
@@ -89,23 +74,8 @@ void pool_vertical_reduce_image_sharded(std::vector<pyOpenFHE_CKKS::CKKSCipherte
     	}
     }
 
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> vertical_reductions(half_num_rows * num_input_shards);
-    #pragma omp parallel for collapse(2)
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        for (int i = 0 ; i < half_num_rows; ++i) {
-            // if performed sequentially, we could have a loop with `shards[s] <<= 3 * half_num_rows`
-            vertical_reductions[i + s * half_num_rows] = (shards[s] << (i * half_num_rows * 3)) * vertical_masks[i];
-        }
-    }
-
-    #pragma omp parallel for
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        auto ctxt = vertical_reductions[s * half_num_rows];
-        for (int i = 1 ; i < half_num_rows; ++i) {
-            ctxt += vertical_reductions[i + s * half_num_rows];
-        }
-        shards[s] = ctxt;
-    }
+    // sum of (shards[s] << (i * half_num_rows * 3)) * vertical_masks[i]
+    shards = rotate_mask_and_sum(shards, half_num_rows * 3, vertical_masks);
 
 }
 
@@ -124,23 +94,34 @@ void pool_vertical_reduce_channel_sharded(std::vector<pyOpenFHE_CKKS::CKKSCipher
     	}
     }
 
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> vertical_reductions(half_num_rows * num_input_shards);
-    #pragma omp parallel for collapse(2)
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        for (int i = 0 ; i < half_num_rows; ++i) {
-            // if performed sequentially, we could have a loop with `shards[s] <<= 3 * half_num_rows`
-            vertical_reductions[i + s * half_num_rows] = (shards[s] << (i * half_num_cols * 3)) * vertical_masks[i];
-        }
-    }
+    // sum of (shards[s] << (i * half_num_cols * 3)) * vertical_masks[i]
+    shards = rotate_mask_and_sum(shards, half_num_cols * 3, vertical_masks);
+}
 
-    #pragma omp parallel for
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        auto ctxt = vertical_reductions[s * half_num_rows];
-        for (int i = 1 ; i < half_num_rows; ++i) {
-            ctxt += vertical_reductions[i + s * half_num_rows];
+/*
+Single-level replacement for pool_horizontal_reduce followed by a vertical reduce.
+Moves (2r, 2c) to (r, c) in every channel, which is a rotation by 3 * half_num_cols * r + c,
+so we use the columns as baby steps and the rows as giant steps with a single mask multiplication.
+This costs more rotations than the two separate reductions but saves a level,
+which is what the strided conv2d is after.
+*/
+void pool_fused_reduce(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int num_rows, int num_cols, int num_physical_channels_per_shard) {
+    int shard_size = shards[0].getBatchSize();
+
+    const int half_num_rows = num_rows / 2;
+    const int half_num_cols = num_cols / 2;
+    const int channel_size = num_rows * num_cols;
+
+    // term r * half_num_cols + c keeps output slot (r, c) of every channel
+    auto fused_mask = [=](int i) {
+        std::vector<double> mask(shard_size);
+        for (int k = 0; k < num_physical_channels_per_shard; ++k) { // channel index
+            mask[i + k * channel_size] = 1.0;
         }
-        shards[s] = ctxt;
-    }
+        return mask;
+    };
+
+    shards = rotate_mask_and_sum_bsgs(shards, 1, half_num_cols, 3 * half_num_cols, half_num_rows * half_num_cols, fused_mask);
 }
 
 std::vector<pyOpenFHE_CKKS::CKKSCiphertext> pool_consolidate_and_duplicate_image_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int num_rows, int num_cols, int num_physical_channels_per_shard) {
@@ -245,6 +226,64 @@ std::vector<pyOpenFHE_CKKS::CKKSCiphertext> pool_consolidate_and_duplicate_chann
     return output_shards;
 }
 
+/*
+Multiplexed pooling never moves data within a channel. It masks out the odd rows and columns,
+which frees 3 of every 4 sub-channel offsets, and slides up to 4 shards into those offsets.
+That is one mask level and a few rotations per shard, instead of the reductions and consolidation above.
+The output has twice the gap. Its channel numbering continues the input's, so the permutation is unchanged.
+*/
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> pool_multiplexed_image_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int mtx_size, int gap, bool conv) {
+    int num_input_shards = shards.size();
+    int shard_size = shards[0].getBatchSize();
+    int num_cols = mtx_size * gap; // physical row length
+
+    double fill_value = 1.0;
+    if (conv) {
+        pool_pre_convolution(shards, num_cols, gap);
+        fill_value = 0.25;
+    }
+
+    // keep the even logical rows and columns, i.e. physical offsets below gap in each 2 * gap block
+    std::vector<double> mask(shard_size);
+    for (int i = 0; i < shard_size; ++i) {
+        int row = i / num_cols;
+        int col = i % num_cols;
+        if (row % (2 * gap) < gap && col % (2 * gap) < gap) {
+            mask[i] = fill_value;
+        }
+    }
+
+    #pragma omp parallel for
+    for (int s = 0; s < num_input_shards; ++s) {
+        shards[s] *= mask;
+    }
+
+    // shard q within a group of 4 moves to row offset (q / 2) * gap and column offset (q % 2) * gap
+    int shift_vals[] = {0, gap, gap * num_cols, gap * (num_cols + 1)};
+
+    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> output_shards;
+    switch (num_input_shards) {
+        case 1:
+            shards[0] += shards[0] >> shift_vals[1];
+            shards[0] += shards[0] >> shift_vals[2];
+            output_shards.push_back(shards[0]);
+            break;
+        case 2:
+            shards[0] += shards[1] >> shift_vals[1];
+            shards[0] += shards[0] >> shift_vals[2];
+            output_shards.push_back(shards[0]);
+            break;
+        default:
+            #pragma omp parallel for
+            for (int s = 0; s < num_input_shards; ++s) {
+                shards[s] >>= shift_vals[s % 4];
+            }
+            output_shards = parallelTreeSumGroups(shards, num_input_shards / 4, 4);
+    }
+
+    return output_shards;
+}
+
 boost::python::list pool_image_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int mtx_size, bool conv) {
     int shard_size = shards[0].getBatchSize();
     int channel_size = mtx_size * mtx_size; // assuming square matrices, may want to change this assumption later though
@@ -303,7 +342,16 @@ boost::python::list pool_channel_sharded(std::vector<pyOpenFHE_CKKS::CKKSCiphert
 
 }
 
-boost::python::list pyOpenFHE_CKKS::pool(const boost::python::list &py_shards, int mtx_size, bool conv) {
+/*
+gap is the interleaving of the input (1 for the usual layout).
+multiplexed = true produces the multiplexed layout with twice the gap, instead of consolidating and duplicating.
+*/
+boost::python::list pyOpenFHE_CKKS::pool(const boost::python::list &py_shards, int mtx_size, bool conv, int gap, bool multiplexed) {
+    check_multiplexed_gap(gap);
+    if (gap > 1 && !multiplexed) {
+        throw std::runtime_error(fmt::format("a multiplexed input (gap = {}) can only be pooled with multiplexed = True", gap));
+    }
+
     int num_input_shards = len(py_shards);
 
     std::vector<pyOpenFHE_CKKS::CKKSCiphertext> shards(num_input_shards);
@@ -315,9 +363,49 @@ boost::python::list pyOpenFHE_CKKS::pool(const boost::python::list &py_shards, i
     int shard_size = shards[0].getBatchSize();
     int channel_size = mtx_size * mtx_size; // assuming square matrices, may want to change this assumption later though
 
+    if (multiplexed) {
+        if (shard_size < channel_size * gap * gap) {
+            throw std::runtime_error("the multiplexed layout needs image-sharded inputs");
+        }
+
+        auto output_shards = pool_multiplexed_image_sharded(shards, mtx_size, gap, conv);
+        int num_output_shards = output_shards.size();
+
+        boost::python::list res = pyOpenFHE::make_list(num_output_shards);
+        for (int s = 0 ; s < num_output_shards; ++s) {
+            res[s] = output_shards[s];
+        }
+        return res;
+    }
+
     if (shard_size >= channel_size) {
         return pool_image_sharded(shards, mtx_size, conv);
     } else {
         return pool_channel_sharded(shards, mtx_size, conv);
     }
-}
\ No newline at end of file
+}
+
+/*
+Downsample and consolidate the output of a stride-1 convolution, as if it were followed by pool(conv=false),
+but with a single reduction level. This is the back half of a stride-2 conv2d.
+*/
+std::vector<pyOpenFHE_CKKS::CKKSCiphertext> pyOpenFHE_CKKS::pool_strided_downsample(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& shards, int mtx_size, int gap, bool multiplexed) {
+    int shard_size = shards[0].getBatchSize();
+    int channel_size = mtx_size * mtx_size; // assuming square matrices, may want to change this assumption later though
+
+    if (multiplexed) {
+        // already a single level
+        return pool_multiplexed_image_sharded(shards, mtx_size, gap, false);
+    }
+
+    if (shard_size >= channel_size) {
+        int num_physical_channels_per_shard = shard_size / channel_size;
+        pool_fused_reduce(shards, mtx_size, mtx_size, num_physical_channels_per_shard);
+        return pool_consolidate_and_duplicate_image_sharded(shards, mtx_size, mtx_size, num_physical_channels_per_shard);
+    } else {
+        int shards_per_channel = channel_size / shard_size;
+        int num_rows_per_shard = mtx_size / shards_per_channel;
+        pool_fused_reduce(shards, num_rows_per_shard, mtx_size, 1);
+        return pool_consolidate_and_duplicate_channel_sharded(shards);
+    }
+}
@@ -1,6 +1,7 @@
 // (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
 
 #include "ckks/CKKS_ciphertext_extension.hpp"
+#include "ckks/cnn/he_cnn.hpp"
 #include "ckks/cnn/upsample.hpp"
 
 #include <stdexcept>
@@ -80,26 +81,8 @@ std::vector<pyOpenFHE_CKKS::CKKSCiphertext> upsample_vertical_expand(const std::
         }
     }
 
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> vertical_expansions(num_rows_per_shard_after_upsample * num_expanded_shards);
-    #pragma omp parallel for collapse(2)
-    for (int s = 0 ; s < num_expanded_shards; ++s) {
-        for (int i = 0 ; i < num_rows_per_shard_after_upsample; ++i) {
-            // if performed sequentially, we could have a loop with `shifted_shards[s] >>= 3 * num_cols`
-            vertical_expansions[i + s * num_rows_per_shard_after_upsample] = (shifted_shards[s] >> (3 * num_cols * i)) * vertical_masks[i];
-        }
-    }
-
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> new_shards(num_expanded_shards);
-    #pragma omp parallel for
-    for (int s = 0; s < num_expanded_shards; ++s) {
-        auto ctxt = vertical_expansions[s * num_rows_per_shard_after_upsample];
-        for (int i = 1 ; i < num_rows_per_shard_after_upsample; ++i) {
-            ctxt += vertical_expansions[i + s * num_rows_per_shard_after_upsample];
-        }
-        new_shards[s] = ctxt;
-    }
-
-    return new_shards;
+    // sum of (shifted_shards[s] >> (3 * num_cols * i)) * vertical_masks[i]
+    return rotate_mask_and_sum(shifted_shards, -3 * num_cols, vertical_masks);
 
 }
 
@@ -134,23 +117,8 @@ void upsample_horizontal_expand(std::vector<pyOpenFHE_CKKS::CKKSCiphertext>& sha
     	}
     }
 
-    std::vector<pyOpenFHE_CKKS::CKKSCiphertext> horizontal_expansions(num_cols * num_input_shards);
-    #pragma omp parallel for collapse(2)
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        for (int i = 0 ; i < num_cols; ++i) {
-            // if performed sequentially, we could have a loop with `shards[s] >>= 1`
-            horizontal_expansions[i + s * num_cols] = (shards[s] >> (i)) * horizontal_masks[i];
-        }
-    }
-
-    #pragma omp parallel for
-    for (int s = 0 ; s < num_input_shards; ++s) {
-        auto ctxt = horizontal_expansions[s * num_cols];
-        for (int i = 1 ; i < num_cols; ++i) {
-            ctxt += horizontal_expansions[i + s * num_cols];
-        }
-        shards[s] = ctxt;
-    }
+    // sum of (shards[s] >> i) * horizontal_masks[i]
+    shards = rotate_mask_and_sum(shards, -1, horizontal_masks);
 
 }
 
@@ -0,0 +1,169 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include <cstring>
+#include <stdexcept>
+
+// string formatting for exceptions
+#include <fmt/format.h>
+
+#include "utils/bundle.hpp"
+
+namespace {
+
+const char bundle_magic[8] = {'P', 'Y', 'O', 'F', 'H', 'E', 'K', 'B'};
+const uint32_t bundle_version = 1;
+const uint64_t bundle_alignment = 4096;
+
+const size_t num_sections = (size_t)pyOpenFHE::BundleSection::NUM_SECTIONS;
+
+// magic, version, scheme, number of sections, then an (offset, length) per section
+const uint64_t toc_position = sizeof(bundle_magic) + 3 * sizeof(uint32_t);
+const uint64_t header_size = toc_position + num_sections * 2 * sizeof(uint64_t);
+
+template <typename T> void writeRaw(std::ostream &os, T value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+T readRaw(const char *&ptr, const char *end, const std::string &filename) {
+  if (end - ptr < (std::ptrdiff_t)sizeof(T)) {
+    throw std::runtime_error("Bundle file is truncated: " + filename);
+  }
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  ptr += sizeof(T);
+  return value;
+}
+
+} // namespace
+
+const char *pyOpenFHE::bundleSectionName(BundleSection section) {
+  switch (section) {
+  case BundleSection::CONTEXT:
+    return "cryptoContext";
+  case BundleSection::PUBLIC_KEY:
+    return "publicKey";
+  case BundleSection::PRIVATE_KEY:
+    return "privateKey";
+  case BundleSection::EVAL_MULT_KEYS:
+    return "evalMultKeys";
+  case BundleSection::EVAL_AUTOMORPHISM_KEYS:
+    return "evalAutomorphismKeys";
+  default:
+    return "unknown";
+  }
+}
+
+pyOpenFHE::BundleSection
+pyOpenFHE::bundleSectionByName(const std::string &name) {
+  for (size_t i = 0; i < num_sections; ++i) {
+    if (name == bundleSectionName((BundleSection)i)) {
+      return (BundleSection)i;
+    }
+  }
+  throw std::runtime_error(fmt::format(
+      "Unknown bundle section '{}', expected one of cryptoContext, publicKey, "
+      "privateKey, evalMultKeys, evalAutomorphismKeys",
+      name));
+}
+
+pyOpenFHE::BundleWriter::BundleWriter(const std::string &filename,
+                                      uint32_t scheme)
+    : filename(filename),
+      file(filename, std::ios::out | std::ios::binary | std::ios::trunc) {
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not write bundle to file: " + filename);
+  }
+
+  file.write(bundle_magic, sizeof(bundle_magic));
+  writeRaw<uint32_t>(file, bundle_version);
+  writeRaw<uint32_t>(file, scheme);
+  writeRaw<uint32_t>(file, num_sections);
+  // the table of contents is filled in by finish
+  for (size_t i = 0; i < 2 * num_sections; ++i) {
+    writeRaw<uint64_t>(file, 0);
+  }
+}
+
+void pyOpenFHE::BundleWriter::beginSection(BundleSection section) {
+  uint64_t position = file.tellp();
+  uint64_t padding = (bundle_alignment - position % bundle_alignment) % bundle_alignment;
+  for (uint64_t i = 0; i < padding; ++i) {
+    file.put('\0');
+  }
+  offsets[(size_t)section] = position + padding;
+}
+
+void pyOpenFHE::BundleWriter::endSection(BundleSection section) {
+  uint64_t position = file.tellp();
+  lengths[(size_t)section] = position - offsets[(size_t)section];
+}
+
+void pyOpenFHE::BundleWriter::finish() {
+  file.seekp(toc_position);
+  for (size_t i = 0; i < num_sections; ++i) {
+    writeRaw<uint64_t>(file, offsets[i]);
+    writeRaw<uint64_t>(file, lengths[i]);
+  }
+  file.close();
+
+  if (!file) {
+    throw std::runtime_error("Could not write bundle to file: " + filename);
+  }
+}
+
+pyOpenFHE::BundleReader::BundleReader(const std::string &filename,
+                                      uint32_t scheme)
+    : filename(filename), file(filename, false) {
+  const char *ptr = file.data();
+  const char *end = file.data() + file.size();
+
+  if (file.size() < header_size ||
+      std::memcmp(ptr, bundle_magic, sizeof(bundle_magic)) != 0) {
+    throw std::runtime_error("Not a bundle file: " + filename);
+  }
+  ptr += sizeof(bundle_magic);
+
+  uint32_t version = readRaw<uint32_t>(ptr, end, filename);
+  if (version != bundle_version) {
+    throw std::runtime_error(fmt::format(
+        "Unsupported bundle version = {} in {}, expected {}", version,
+        filename, bundle_version));
+  }
+
+  uint32_t file_scheme = readRaw<uint32_t>(ptr, end, filename);
+  if (file_scheme != scheme) {
+    throw std::runtime_error(fmt::format(
+        "Bundle {} was made for scheme = {}, expected {}", filename,
+        file_scheme, scheme));
+  }
+
+  uint32_t file_sections = readRaw<uint32_t>(ptr, end, filename);
+  if (file_sections != num_sections) {
+    throw std::runtime_error(fmt::format(
+        "Bundle {} has {} sections, expected {}", filename, file_sections,
+        num_sections));
+  }
+
+  for (size_t i = 0; i < num_sections; ++i) {
+    offsets[i] = readRaw<uint64_t>(ptr, end, filename);
+    lengths[i] = readRaw<uint64_t>(ptr, end, filename);
+    if (offsets[i] > file.size() || lengths[i] > file.size() - offsets[i]) {
+      throw std::runtime_error(fmt::format(
+          "Bundle file is truncated: {}, section {} runs past the end",
+          filename, bundleSectionName((BundleSection)i)));
+    }
+  }
+}
+
+bool pyOpenFHE::BundleReader::has(BundleSection section) const {
+  return lengths[(size_t)section] > 0;
+}
+
+size_t pyOpenFHE::BundleReader::checkedIndex(BundleSection section) const {
+  if (!has(section)) {
+    throw std::runtime_error(fmt::format("Bundle {} has no {} section",
+                                         filename, bundleSectionName(section)));
+  }
+  return (size_t)section;
+}
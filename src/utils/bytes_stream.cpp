@@ -0,0 +1,117 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// string formatting for exceptions
+#include <fmt/format.h>
+
+#include "utils/bytes_stream.hpp"
+
+namespace {
+
+// big enough that small keys never resize, small next to any ciphertext
+const size_t initial_capacity = 1 << 16;
+
+} // namespace
+
+pyOpenFHE::BytesStreambuf::BytesStreambuf() {
+  bytes = PyBytes_FromStringAndSize(nullptr, initial_capacity);
+  if (bytes == nullptr) {
+    throw_error_already_set();
+  }
+  char *base = PyBytes_AS_STRING(bytes);
+  setp(base, base + initial_capacity);
+}
+
+pyOpenFHE::BytesStreambuf::~BytesStreambuf() { Py_XDECREF(bytes); }
+
+size_t pyOpenFHE::BytesStreambuf::used() const {
+  return pptr() - PyBytes_AS_STRING(bytes);
+}
+
+void pyOpenFHE::BytesStreambuf::grow(size_t minimum) {
+  size_t offset = used();
+  size_t capacity = std::max(2 * (size_t)PyBytes_GET_SIZE(bytes), minimum);
+  if (_PyBytes_Resize(&bytes, capacity) != 0) {
+    // _PyBytes_Resize has already freed the bytes and set a MemoryError
+    bytes = nullptr;
+    throw_error_already_set();
+  }
+
+  char *base = PyBytes_AS_STRING(bytes);
+  setp(base + offset, base + capacity);
+}
+
+std::streambuf::int_type pyOpenFHE::BytesStreambuf::overflow(int_type ch) {
+  if (traits_type::eq_int_type(ch, traits_type::eof())) {
+    return traits_type::not_eof(ch);
+  }
+  grow(used() + 1);
+  *pptr() = traits_type::to_char_type(ch);
+  setp(pptr() + 1, epptr());
+  return ch;
+}
+
+std::streamsize pyOpenFHE::BytesStreambuf::xsputn(const char *s,
+                                                  std::streamsize n) {
+  if (epptr() - pptr() < n) {
+    grow(used() + n);
+  }
+  std::memcpy(pptr(), s, n);
+  setp(pptr() + n, epptr());
+  return n;
+}
+
+PyObject *pyOpenFHE::BytesStreambuf::release() {
+  if (_PyBytes_Resize(&bytes, used()) != 0) {
+    bytes = nullptr;
+    throw_error_already_set();
+  }
+  PyObject *result = bytes;
+  bytes = nullptr;
+  setp(nullptr, nullptr);
+  return result;
+}
+
+pyOpenFHE::BytesOStream::BytesOStream() : std::ostream(nullptr) {
+  rdbuf(&buffer);
+  // otherwise the ostream swallows a MemoryError from growing and sets badbit
+  exceptions(std::ios::badbit);
+}
+
+pyOpenFHE::FixedStreambuf::FixedStreambuf(char *data, size_t size)
+    : begin(data) {
+  setp(data, data + size);
+}
+
+std::streambuf::int_type pyOpenFHE::FixedStreambuf::overflow(int_type ch) {
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    dropped++;
+  }
+  return traits_type::not_eof(ch);
+}
+
+std::streamsize pyOpenFHE::FixedStreambuf::xsputn(const char *s,
+                                                  std::streamsize n) {
+  std::streamsize fits = std::min(n, (std::streamsize)(epptr() - pptr()));
+  std::memcpy(pptr(), s, fits);
+  setp(pptr() + fits, epptr());
+  // cereal treats a short write as an error, so claim all of it and remember the rest
+  dropped += n - fits;
+  return n;
+}
+
+pyOpenFHE::FixedOStream::FixedOStream(char *data, size_t size)
+    : std::ostream(nullptr), buffer(data, size) {
+  rdbuf(&buffer);
+}
+
+void pyOpenFHE::checkSerializedFits(size_t requested, size_t capacity) {
+  if (requested > capacity) {
+    throw std::runtime_error(fmt::format(
+        "Buffer of {} bytes is too small, serializing needs {} bytes", capacity,
+        requested));
+  }
+}
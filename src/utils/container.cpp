@@ -0,0 +1,98 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include <cstring>
+
+// string formatting for exceptions
+#include <fmt/format.h>
+
+#include "utils/container.hpp"
+
+namespace {
+
+const char container_magic[8] = {'P', 'Y', 'O', 'F', 'H', 'E', 'C', 'L'};
+const uint32_t container_version = 1;
+
+// magic, version, scheme, sertype, count, then the table
+const uint64_t table_position = sizeof(container_magic) + 4 * sizeof(uint32_t);
+
+template <typename T> void writeRaw(std::ostream &os, T value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+T readRaw(const char *&ptr, const char *end, const std::string &source) {
+  if (end - ptr < (std::ptrdiff_t)sizeof(T)) {
+    throw std::runtime_error("Ciphertext list container is truncated: " +
+                             source);
+  }
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  ptr += sizeof(T);
+  return value;
+}
+
+} // namespace
+
+void pyOpenFHE::writeContainer(std::ostream &os, uint32_t scheme,
+                               uint32_t sertype,
+                               const std::vector<std::string> &shards) {
+  os.write(container_magic, sizeof(container_magic));
+  writeRaw<uint32_t>(os, container_version);
+  writeRaw<uint32_t>(os, scheme);
+  writeRaw<uint32_t>(os, sertype);
+  writeRaw<uint32_t>(os, shards.size());
+
+  uint64_t offset = table_position + shards.size() * 2 * sizeof(uint64_t);
+  for (auto &shard : shards) {
+    writeRaw<uint64_t>(os, offset);
+    writeRaw<uint64_t>(os, shard.size());
+    offset += shard.size();
+  }
+
+  for (auto &shard : shards) {
+    os.write(shard.data(), shard.size());
+  }
+}
+
+pyOpenFHE::ContainerReader::ContainerReader(const char *data, size_t size,
+                                            uint32_t scheme,
+                                            const std::string &source)
+    : data(data) {
+  const char *ptr = data;
+  const char *end = data + size;
+
+  if (size < table_position ||
+      std::memcmp(ptr, container_magic, sizeof(container_magic)) != 0) {
+    throw std::runtime_error("Not a ciphertext list container: " + source);
+  }
+  ptr += sizeof(container_magic);
+
+  uint32_t version = readRaw<uint32_t>(ptr, end, source);
+  if (version != container_version) {
+    throw std::runtime_error(fmt::format(
+        "Unsupported ciphertext list container version = {} in {}, expected {}",
+        version, source, container_version));
+  }
+
+  uint32_t file_scheme = readRaw<uint32_t>(ptr, end, source);
+  if (file_scheme != scheme) {
+    throw std::runtime_error(fmt::format(
+        "Ciphertext list container {} was made for scheme = {}, expected {}",
+        source, file_scheme, scheme));
+  }
+
+  sertype = readRaw<uint32_t>(ptr, end, source);
+  uint32_t count = readRaw<uint32_t>(ptr, end, source);
+  for (uint32_t i = 0; i < count; ++i) {
+    uint64_t offset = readRaw<uint64_t>(ptr, end, source);
+    uint64_t length = readRaw<uint64_t>(ptr, end, source);
+    if (offset > size || length > size - offset) {
+      throw std::runtime_error(fmt::format(
+          "Ciphertext list container is truncated: {}, shard {} runs past the "
+          "end",
+          source, i));
+    }
+    offsets.push_back(offset);
+    lengths.push_back(length);
+  }
+}
@@ -0,0 +1,44 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include "utils/eval_keys.hpp"
+
+using namespace lbcrypto;
+
+pyOpenFHE::EvalMultKeyMap
+pyOpenFHE::contextEvalMultKeys(const CryptoContext<DCRTPoly> &cc) {
+  EvalMultKeyMap keys;
+  for (auto &tagged : CryptoContextImpl<DCRTPoly>::GetAllEvalMultKeys()) {
+    if (!tagged.second.empty() &&
+        tagged.second[0]->GetCryptoContext() == cc) {
+      keys[tagged.first] = tagged.second;
+    }
+  }
+  return keys;
+}
+
+pyOpenFHE::EvalAutomorphismKeyMap
+pyOpenFHE::contextEvalAutomorphismKeys(const CryptoContext<DCRTPoly> &cc) {
+  EvalAutomorphismKeyMap keys;
+  for (auto &tagged :
+       CryptoContextImpl<DCRTPoly>::GetAllEvalAutomorphismKeys()) {
+    if (tagged.second && !tagged.second->empty() &&
+        tagged.second->begin()->second->GetCryptoContext() == cc) {
+      // OpenFHE adds rotation keys to this map in place, so copy it
+      keys[tagged.first] =
+          std::make_shared<std::map<uint32_t, EvalKey<DCRTPoly>>>(
+              *tagged.second);
+    }
+  }
+  return keys;
+}
+
+std::shared_ptr<std::map<uint32_t, EvalKey<DCRTPoly>>>
+pyOpenFHE::taggedEvalAutomorphismKeys(const std::string &tag) {
+  auto &all_keys = CryptoContextImpl<DCRTPoly>::GetAllEvalAutomorphismKeys();
+  auto tagged = all_keys.find(tag);
+  if (tagged == all_keys.end() || !tagged->second) {
+    return nullptr;
+  }
+  return std::make_shared<std::map<uint32_t, EvalKey<DCRTPoly>>>(
+      *tagged->second);
+}
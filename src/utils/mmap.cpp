@@ -0,0 +1,100 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// string formatting for exceptions
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/mmap.hpp"
+
+pyOpenFHE::MemoryStreambuf::MemoryStreambuf(const char *data, size_t size) {
+  // streambuf wants non-const pointers, but we never write through them
+  char *begin = const_cast<char *>(data);
+  setg(begin, begin, begin + size);
+}
+
+std::streambuf::pos_type
+pyOpenFHE::MemoryStreambuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                    std::ios_base::openmode which) {
+  char *target = nullptr;
+  if (dir == std::ios_base::beg) {
+    target = eback() + off;
+  } else if (dir == std::ios_base::cur) {
+    target = gptr() + off;
+  } else {
+    target = egptr() + off;
+  }
+  if (!(which & std::ios_base::in) || target < eback() || target > egptr()) {
+    return pos_type(off_type(-1));
+  }
+  setg(eback(), target, egptr());
+  return pos_type(target - eback());
+}
+
+std::streambuf::pos_type
+pyOpenFHE::MemoryStreambuf::seekpos(pos_type pos,
+                                    std::ios_base::openmode which) {
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+pyOpenFHE::MemoryIStream::MemoryIStream(const char *data, size_t size)
+    : std::istream(nullptr), buffer(data, size) {
+  rdbuf(&buffer);
+}
+
+pyOpenFHE::MappedFile::MappedFile(const std::string &filename,
+                                  bool sequential) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(fmt::format("Could not open file: {} ({})",
+                                         filename, std::strerror(errno)));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error(fmt::format("Could not stat file: {} ({})",
+                                         filename, std::strerror(errno)));
+  }
+  length = st.st_size;
+
+  // mmap refuses empty mappings, and there's nothing to read anyway
+  if (length > 0) {
+    void *ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error(fmt::format("Could not memory map file: {} ({})",
+                                           filename, std::strerror(errno)));
+    }
+    madvise(ptr, length, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    mapped = static_cast<const char *>(ptr);
+  }
+  close(fd);
+}
+
+pyOpenFHE::MappedFile::~MappedFile() {
+  if (mapped != nullptr) {
+    munmap(const_cast<char *>(mapped), length);
+  }
+}
+
+void pyOpenFHE::MappedFile::willNeed(size_t offset, size_t count) const {
+  if (mapped == nullptr || offset >= length) {
+    return;
+  }
+  count = std::min(count, length - offset);
+
+  // madvise wants a page aligned start
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t start = offset - offset % page;
+  madvise(const_cast<char *>(mapped) + start, count + (offset - start),
+          MADV_WILLNEED);
+}
@@ -0,0 +1,267 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// string formatting for exceptions
+#include <fmt/format.h>
+
+#include <omp.h>
+
+#include "utils/records.hpp"
+
+using namespace lbcrypto;
+
+namespace {
+
+const char records_magic[8] = {'P', 'Y', 'O', 'F', 'H', 'E', 'R', 'S'};
+const char index_magic[8] = {'P', 'Y', 'O', 'F', 'H', 'E', 'R', 'I'};
+const uint32_t records_version = 1;
+
+// magic, version, scheme, sertype
+const uint64_t header_size = sizeof(records_magic) + 3 * sizeof(uint32_t);
+// index position, record count, magic
+const uint64_t trailer_size = 2 * sizeof(uint64_t) + sizeof(index_magic);
+
+template <typename T> void writeRaw(std::ostream &os, T value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T readRaw(const char *ptr) {
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+} // namespace
+
+pyOpenFHE::RecordWriter::RecordWriter(const std::string &filename,
+                                      uint32_t scheme, uint32_t sertype)
+    : filename(filename),
+      file(filename, std::ios::out | std::ios::binary | std::ios::trunc) {
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open ciphertext record file: " +
+                             filename);
+  }
+  file.write(records_magic, sizeof(records_magic));
+  writeRaw<uint32_t>(file, records_version);
+  writeRaw<uint32_t>(file, scheme);
+  writeRaw<uint32_t>(file, sertype);
+  check("header");
+  position = header_size;
+}
+
+pyOpenFHE::RecordWriter::~RecordWriter() {
+  try {
+    close();
+  } catch (const std::exception &) {
+  }
+}
+
+void pyOpenFHE::RecordWriter::check(const char *what) {
+  if (!file) {
+    throw std::runtime_error(fmt::format(
+        "Could not write the {} of ciphertext record file: {}", what, filename));
+  }
+}
+
+void pyOpenFHE::RecordWriter::append(const std::string &record) {
+  if (closed()) {
+    throw std::runtime_error("Ciphertext record file is already closed: " +
+                             filename);
+  }
+  writeRaw<uint64_t>(file, record.size());
+  file.write(record.data(), record.size());
+  check("records");
+
+  offsets.push_back(position + sizeof(uint64_t));
+  lengths.push_back(record.size());
+  position += sizeof(uint64_t) + record.size();
+}
+
+void pyOpenFHE::RecordWriter::close() {
+  if (closed()) {
+    return;
+  }
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    writeRaw<uint64_t>(file, offsets[i]);
+    writeRaw<uint64_t>(file, lengths[i]);
+  }
+  writeRaw<uint64_t>(file, position);
+  writeRaw<uint64_t>(file, offsets.size());
+  file.write(index_magic, sizeof(index_magic));
+  file.close();
+  check("index");
+}
+
+pyOpenFHE::RecordReader::RecordReader(const std::string &filename,
+                                      uint32_t scheme)
+    : filename(filename), file(filename, false) {
+  const char *data = file.data();
+  if (file.size() < header_size ||
+      std::memcmp(data, records_magic, sizeof(records_magic)) != 0) {
+    throw std::runtime_error("Not a ciphertext record file: " + filename);
+  }
+
+  uint32_t version = readRaw<uint32_t>(data + sizeof(records_magic));
+  if (version != records_version) {
+    throw std::runtime_error(fmt::format(
+        "Unsupported ciphertext record file version = {} in {}, expected {}",
+        version, filename, records_version));
+  }
+
+  uint32_t file_scheme =
+      readRaw<uint32_t>(data + sizeof(records_magic) + sizeof(uint32_t));
+  if (file_scheme != scheme) {
+    throw std::runtime_error(fmt::format(
+        "Ciphertext record file {} was made for scheme = {}, expected {}",
+        filename, file_scheme, scheme));
+  }
+  sertype =
+      readRaw<uint32_t>(data + sizeof(records_magic) + 2 * sizeof(uint32_t));
+
+  if (!readIndex()) {
+    scanRecords(header_size);
+  }
+}
+
+bool pyOpenFHE::RecordReader::readIndex() {
+  size_t size = file.size();
+  const char *data = file.data();
+  if (size < header_size + trailer_size ||
+      std::memcmp(data + size - sizeof(index_magic), index_magic,
+                  sizeof(index_magic)) != 0) {
+    return false;
+  }
+
+  const char *trailer = data + size - trailer_size;
+  uint64_t index_position = readRaw<uint64_t>(trailer);
+  uint64_t count = readRaw<uint64_t>(trailer + sizeof(uint64_t));
+  uint64_t index_end = size - trailer_size;
+  if (index_position < header_size || index_position > index_end ||
+      (index_end - index_position) / (2 * sizeof(uint64_t)) != count ||
+      (index_end - index_position) % (2 * sizeof(uint64_t)) != 0) {
+    throw std::runtime_error("Ciphertext record file has a corrupt index: " +
+                             filename);
+  }
+
+  const char *ptr = data + index_position;
+  for (uint64_t i = 0; i < count; ++i) {
+    uint64_t offset = readRaw<uint64_t>(ptr);
+    uint64_t length = readRaw<uint64_t>(ptr + sizeof(uint64_t));
+    ptr += 2 * sizeof(uint64_t);
+    if (offset > index_position || length > index_position - offset) {
+      throw std::runtime_error(fmt::format(
+          "Ciphertext record file has a corrupt index: {}, record {} runs "
+          "past the end",
+          filename, i));
+    }
+    offsets.push_back(offset);
+    lengths.push_back(length);
+  }
+  return true;
+}
+
+void pyOpenFHE::RecordReader::scanRecords(uint64_t position) {
+  size_t size = file.size();
+  while (size - position >= sizeof(uint64_t)) {
+    uint64_t length = readRaw<uint64_t>(file.data() + position);
+    position += sizeof(uint64_t);
+    if (length > size - position) {
+      // the writer died in the middle of this one
+      break;
+    }
+    offsets.push_back(position);
+    lengths.push_back(length);
+    position += length;
+  }
+}
+
+void pyOpenFHE::RecordReader::willNeed(size_t first, size_t last) const {
+  last = std::min(last, count());
+  if (first >= last) {
+    return;
+  }
+  size_t begin = offsets[first];
+  size_t end = offsets[last - 1] + lengths[last - 1];
+  file.willNeed(begin, end - begin);
+}
+
+std::vector<Ciphertext<DCRTPoly>>
+pyOpenFHE::readRecords(const RecordReader &reader,
+                       const RecordDeserializer &deserialize, size_t first,
+                       size_t count, int numThreads) {
+  if (first > reader.count() || count > reader.count() - first) {
+    throw std::runtime_error(fmt::format(
+        "Records [{}, {}) are out of range, the file has {}", first,
+        first + count, reader.count()));
+  }
+
+  std::vector<Ciphertext<DCRTPoly>> ctxts(count);
+  std::string error;
+  int threads = numThreads > 0 ? numThreads : omp_get_max_threads();
+
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+  for (int i = 0; i < (int)count; ++i) {
+    try {
+      ctxts[i] = deserialize(reader.recordData(first + i),
+                             reader.recordSize(first + i));
+    } catch (const std::exception &e) {
+#pragma omp critical
+      if (error.empty()) {
+        error = e.what();
+      }
+    }
+  }
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+  return ctxts;
+}
+
+pyOpenFHE::RecordPrefetcher::RecordPrefetcher(const RecordReader &reader,
+                                              RecordDeserializer deserialize,
+                                              size_t batchSize, size_t depth)
+    : reader(reader), deserialize(std::move(deserialize)),
+      batchSize(std::max<size_t>(batchSize, 1)),
+      depth(std::max<size_t>(depth, 1)) {}
+
+pyOpenFHE::RecordPrefetcher::~RecordPrefetcher() { drain(); }
+
+void pyOpenFHE::RecordPrefetcher::drain() {
+  for (auto &batch : pending) {
+    batch.wait();
+  }
+  pending.clear();
+}
+
+void pyOpenFHE::RecordPrefetcher::schedule() {
+  while (pending.size() < depth && scheduled < reader.count()) {
+    size_t first = scheduled;
+    size_t count = std::min(batchSize, reader.count() - first);
+    scheduled += count;
+
+    reader.willNeed(first, first + count);
+    pending.push_back(std::async(std::launch::async, [this, first, count]() {
+      return readRecords(reader, deserialize, first, count, 1);
+    }));
+  }
+}
+
+std::vector<Ciphertext<DCRTPoly>> pyOpenFHE::RecordPrefetcher::next() {
+  schedule();
+  if (pending.empty()) {
+    return {};
+  }
+  auto batch = std::move(pending.front());
+  pending.pop_front();
+  // keep the pipeline full while the caller works on this batch
+  schedule();
+  return batch.get();
+}
+
+void pyOpenFHE::RecordPrefetcher::restart(size_t first) {
+  drain();
+  scheduled = std::min(first, reader.count());
+}
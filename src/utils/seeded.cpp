@@ -0,0 +1,188 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// string formatting for exceptions
+#include <fmt/format.h>
+
+#include <omp.h>
+
+#include "utils/seeded.hpp"
+
+// the XOF behind OpenFHE's default PRNG
+#include "utils/prng/blake2.h"
+
+using namespace lbcrypto;
+
+namespace {
+
+const char seeded_magic[8] = {'P', 'Y', 'O', 'F', 'H', 'E', 'S', 'D'};
+const uint32_t seeded_version = 1;
+
+/*
+The words for tower i come from blake2xb keyed by the seed, over (i, block),
+so every tower can be expanded independently and in parallel.
+*/
+class UniformStream {
+public:
+  UniformStream(const pyOpenFHE::PRNGSeed &seed, uint64_t tower)
+      : seed(seed), tower(tower), words(block_words) {}
+
+  uint64_t next() {
+    if (index == block_words) {
+      refill();
+    }
+    return words[index++];
+  }
+
+private:
+  static const size_t block_words = 128;
+
+  void refill() {
+    uint64_t input[2] = {tower, block++};
+    if (blake2xb(words.data(), block_words * sizeof(uint64_t), input,
+                 sizeof(input), seed.data(), seed.size()) != 0) {
+      throw std::runtime_error("Could not expand the seed of a ciphertext");
+    }
+    index = 0;
+  }
+
+  const pyOpenFHE::PRNGSeed &seed;
+  uint64_t tower;
+  uint64_t block = 0;
+  std::vector<uint64_t> words;
+  size_t index = block_words;
+};
+
+} // namespace
+
+pyOpenFHE::PRNGSeed pyOpenFHE::freshSeed() {
+  std::random_device rd;
+  PRNGSeed seed;
+  for (size_t i = 0; i < seed.size(); i += sizeof(uint32_t)) {
+    uint32_t word = rd();
+    std::memcpy(seed.data() + i, &word, sizeof(word));
+  }
+  return seed;
+}
+
+DCRTPoly
+pyOpenFHE::expandUniform(const PRNGSeed &seed,
+                         const std::shared_ptr<DCRTPoly::Params> &params) {
+  DCRTPoly a(params, Format::EVALUATION, true);
+  const auto &towers = params->GetParams();
+  uint32_t ring_dim = params->GetRingDimension();
+  int num_towers = towers.size();
+
+#pragma omp parallel for
+  for (int i = 0; i < num_towers; ++i) {
+    NativeInteger modulus = towers[i]->GetModulus();
+    uint64_t q = modulus.ConvertToInt<uint64_t>();
+    usint bits = modulus.GetMSB();
+    uint64_t mask = (bits >= 64) ? ~0ULL : ((1ULL << bits) - 1);
+
+    // rejection sampling, so every residue is equally likely
+    UniformStream stream(seed, i);
+    NativeVector values(ring_dim, modulus);
+    for (uint32_t j = 0; j < ring_dim; ++j) {
+      uint64_t x;
+      do {
+        x = stream.next() & mask;
+      } while (x >= q);
+      values[j] = x;
+    }
+    a.GetAllElements()[i].SetValues(std::move(values), Format::EVALUATION);
+  }
+  return a;
+}
+
+void pyOpenFHE::reseedCiphertext(Ciphertext<DCRTPoly> &ctxt,
+                                 const PrivateKey<DCRTPoly> &privateKey,
+                                 const PRNGSeed &seed) {
+  auto &elements = ctxt->GetElements();
+  if (elements.size() != 2) {
+    throw std::runtime_error(fmt::format(
+        "Only fresh ciphertexts with 2 elements can be seeded, this one has {}",
+        elements.size()));
+  }
+
+  // s at the level of the ciphertext
+  DCRTPoly s = privateKey->GetPrivateElement();
+  size_t towers = elements[1].GetNumOfElements();
+  if (s.GetNumOfElements() < towers) {
+    throw std::runtime_error(
+        "The private key has fewer towers than the ciphertext to be seeded");
+  }
+  s.DropLastElements(s.GetNumOfElements() - towers);
+
+  // OpenFHE decrypts b + a*s, so keep that fixed: b' = b + (a - a')*s
+  DCRTPoly a = expandUniform(seed, elements[1].GetParams());
+  elements[0] += (elements[1] - a) * s;
+  elements[1] = std::move(a);
+}
+
+Ciphertext<DCRTPoly>
+pyOpenFHE::dropUniform(const Ciphertext<DCRTPoly> &ctxt) {
+  auto compact = ctxt->Clone();
+  compact->GetElements().pop_back();
+  return compact;
+}
+
+void pyOpenFHE::restoreUniform(Ciphertext<DCRTPoly> &ctxt,
+                               const PRNGSeed &seed) {
+  auto &elements = ctxt->GetElements();
+  if (elements.size() != 1) {
+    throw std::runtime_error(fmt::format(
+        "A seeded ciphertext should have 1 element, this one has {}",
+        elements.size()));
+  }
+  elements.push_back(expandUniform(seed, elements[0].GetParams()));
+}
+
+void pyOpenFHE::writeSeededHeader(std::ostream &os, uint32_t scheme,
+                                  const PRNGSeed &seed) {
+  os.write(seeded_magic, sizeof(seeded_magic));
+  os.write(reinterpret_cast<const char *>(&seeded_version),
+           sizeof(seeded_version));
+  os.write(reinterpret_cast<const char *>(&scheme), sizeof(scheme));
+  os.write(reinterpret_cast<const char *>(seed.data()), seed.size());
+}
+
+pyOpenFHE::PRNGSeed pyOpenFHE::readSeededHeader(const char *&ptr,
+                                                const char *end,
+                                                uint32_t scheme,
+                                                const std::string &source) {
+  const size_t header_size =
+      sizeof(seeded_magic) + 2 * sizeof(uint32_t) + sizeof(PRNGSeed);
+  if ((size_t)(end - ptr) < header_size ||
+      std::memcmp(ptr, seeded_magic, sizeof(seeded_magic)) != 0) {
+    throw std::runtime_error("Not a seeded ciphertext: " + source);
+  }
+  ptr += sizeof(seeded_magic);
+
+  uint32_t version;
+  std::memcpy(&version, ptr, sizeof(version));
+  ptr += sizeof(version);
+  if (version != seeded_version) {
+    throw std::runtime_error(fmt::format(
+        "Unsupported seeded ciphertext version = {} in {}, expected {}",
+        version, source, seeded_version));
+  }
+
+  uint32_t file_scheme;
+  std::memcpy(&file_scheme, ptr, sizeof(file_scheme));
+  ptr += sizeof(file_scheme);
+  if (file_scheme != scheme) {
+    throw std::runtime_error(fmt::format(
+        "Seeded ciphertext {} was made for scheme = {}, expected {}", source,
+        file_scheme, scheme));
+  }
+
+  PRNGSeed seed;
+  std::memcpy(seed.data(), ptr, seed.size());
+  ptr += seed.size();
+  return seed;
+}
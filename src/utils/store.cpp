@@ -0,0 +1,347 @@
+// (c) 2021-2024 The Johns Hopkins University Applied Physics Laboratory LLC (JHU/APL).
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// string formatting for exceptions
+#include <fmt/format.h>
+
+#include <omp.h>
+
+#include "utils/store.hpp"
+
+using namespace lbcrypto;
+
+namespace {
+
+const char store_magic[8] = {'P', 'Y', 'O', 'F', 'H', 'E', 'C', 'S'};
+const uint32_t store_version = 1;
+const uint64_t page_size = 4096;
+
+// magic, version, scheme, ring dimension, number of moduli, count, index position
+const uint64_t header_size =
+    sizeof(store_magic) + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+uint64_t alignUp(uint64_t position, uint64_t alignment) {
+  return (position + alignment - 1) / alignment * alignment;
+}
+
+uint64_t limbStride(uint32_t ringDim) {
+  return alignUp(ringDim * sizeof(uint64_t), page_size);
+}
+
+template <typename T> void writeRaw(std::ostream &os, T value) {
+  os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T readRaw(const char *&ptr) {
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  ptr += sizeof(T);
+  return value;
+}
+
+// tracks the position, since tellp on a large ofstream isn't free
+class StoreOutput {
+public:
+  explicit StoreOutput(const std::string &filename)
+      : filename(filename),
+        file(filename, std::ios::out | std::ios::binary | std::ios::trunc) {
+    if (!file.is_open()) {
+      throw std::runtime_error("Could not open ciphertext store: " + filename);
+    }
+  }
+
+  void write(const void *data, size_t size) {
+    file.write(static_cast<const char *>(data), size);
+    position += size;
+  }
+
+  void padTo(uint64_t alignment) {
+    static const char zeros[page_size] = {};
+    uint64_t padding = alignUp(position, alignment) - position;
+    write(zeros, padding);
+  }
+
+  void seekStart() { file.seekp(0); }
+
+  void close() {
+    file.close();
+    if (!file) {
+      throw std::runtime_error("Could not write ciphertext store: " + filename);
+    }
+  }
+
+  std::string filename;
+  std::ofstream file;
+  uint64_t position = 0;
+};
+
+void writeHeader(StoreOutput &out, uint32_t scheme, uint32_t ringDim,
+                 const std::vector<uint64_t> &moduli, uint64_t count,
+                 uint64_t indexPosition) {
+  out.file.write(store_magic, sizeof(store_magic));
+  writeRaw<uint32_t>(out.file, store_version);
+  writeRaw<uint32_t>(out.file, scheme);
+  writeRaw<uint32_t>(out.file, ringDim);
+  writeRaw<uint32_t>(out.file, moduli.size());
+  writeRaw<uint64_t>(out.file, count);
+  writeRaw<uint64_t>(out.file, indexPosition);
+  for (uint64_t modulus : moduli) {
+    writeRaw<uint64_t>(out.file, modulus);
+  }
+}
+
+} // namespace
+
+void pyOpenFHE::writeCiphertextStore(
+    const std::string &filename, uint32_t scheme,
+    const std::vector<Ciphertext<DCRTPoly>> &ctxts) {
+  if (ctxts.empty()) {
+    throw std::runtime_error("Can't write an empty ciphertext store");
+  }
+
+  auto cc = ctxts[0]->GetCryptoContext();
+  auto &towers = cc->GetElementParams()->GetParams();
+  uint32_t ringDim = cc->GetRingDimension();
+  std::vector<uint64_t> moduli;
+  for (auto &tower : towers) {
+    moduli.push_back(tower->GetModulus().ConvertToInt<uint64_t>());
+  }
+
+  StoreOutput out(filename);
+  // the header is written again at the end, once we know where the index is
+  writeHeader(out, scheme, ringDim, moduli, ctxts.size(), 0);
+  out.position = header_size + moduli.size() * sizeof(uint64_t);
+
+  std::vector<StoreEntry> entries;
+  std::vector<uint64_t> limb(ringDim);
+  for (size_t i = 0; i < ctxts.size(); ++i) {
+    auto &ctxt = ctxts[i];
+    if (ctxt->GetCryptoContext() != cc) {
+      throw std::runtime_error(fmt::format(
+          "Ciphertext {} of the store has a different CryptoContext", i));
+    }
+
+    auto &elements = ctxt->GetElements();
+    StoreEntry entry = {};
+    entry.numElements = elements.size();
+    entry.numTowers = elements[0].GetNumOfElements();
+    entry.level = ctxt->GetLevel();
+    entry.noiseScaleDeg = ctxt->GetNoiseScaleDeg();
+    entry.slots = ctxt->GetSlots();
+    entry.encodingType = ctxt->GetEncodingType();
+    entry.scalingFactor = ctxt->GetScalingFactor();
+    entry.scalingFactorInt =
+        ctxt->GetScalingFactorInt().ConvertToInt<uint64_t>();
+
+    out.padTo(page_size);
+    entry.offset = out.position;
+    for (auto &element : elements) {
+      if (element.GetFormat() != Format::EVALUATION) {
+        throw std::runtime_error(fmt::format(
+            "Ciphertext {} of the store is not in EVALUATION format", i));
+      }
+      for (uint32_t t = 0; t < entry.numTowers; ++t) {
+        auto &values = element.GetElementAtIndex(t).GetValues();
+        if (values.GetModulus().ConvertToInt<uint64_t>() != moduli[t]) {
+          throw std::runtime_error(fmt::format(
+              "Tower {} of ciphertext {} doesn't use the modulus of its "
+              "CryptoContext",
+              t, i));
+        }
+        for (uint32_t j = 0; j < ringDim; ++j) {
+          limb[j] = values[j].ConvertToInt<uint64_t>();
+        }
+        out.write(limb.data(), ringDim * sizeof(uint64_t));
+        out.padTo(page_size);
+      }
+    }
+
+    const std::string &tag = ctxt->GetKeyTag();
+    entry.tagOffset = out.position;
+    entry.tagLength = tag.size();
+    out.write(tag.data(), tag.size());
+    entries.push_back(entry);
+  }
+
+  out.padTo(sizeof(uint64_t));
+  uint64_t indexPosition = out.position;
+  out.write(entries.data(), entries.size() * sizeof(StoreEntry));
+
+  out.seekStart();
+  writeHeader(out, scheme, ringDim, moduli, ctxts.size(), indexPosition);
+  out.close();
+}
+
+pyOpenFHE::MappedCiphertextStore::MappedCiphertextStore(
+    const std::string &filename, const CryptoContext<DCRTPoly> &cc,
+    uint32_t scheme, size_t cacheSize)
+    : filename(filename), file(filename, false), cc(cc),
+      cacheSize(cacheSize) {
+  const char *ptr = file.data();
+  const char *end = file.data() + file.size();
+  if (file.size() < header_size ||
+      std::memcmp(ptr, store_magic, sizeof(store_magic)) != 0) {
+    throw std::runtime_error("Not a ciphertext store: " + filename);
+  }
+  ptr += sizeof(store_magic);
+
+  uint32_t version = readRaw<uint32_t>(ptr);
+  if (version != store_version) {
+    throw std::runtime_error(
+        fmt::format("Unsupported ciphertext store version = {} in {}, "
+                    "expected {}",
+                    version, filename, store_version));
+  }
+  uint32_t file_scheme = readRaw<uint32_t>(ptr);
+  if (file_scheme != scheme) {
+    throw std::runtime_error(fmt::format(
+        "Ciphertext store {} was made for scheme = {}, expected {}", filename,
+        file_scheme, scheme));
+  }
+
+  ringDim = readRaw<uint32_t>(ptr);
+  uint32_t numModuli = readRaw<uint32_t>(ptr);
+  uint64_t count = readRaw<uint64_t>(ptr);
+  uint64_t indexPosition = readRaw<uint64_t>(ptr);
+
+  // the store is only usable with the context its ciphertexts came from
+  auto full = cc->GetElementParams();
+  auto &towers = full->GetParams();
+  if (ringDim != cc->GetRingDimension() || numModuli != towers.size() ||
+      (uint64_t)(end - ptr) < numModuli * sizeof(uint64_t)) {
+    throw std::runtime_error(fmt::format(
+        "Ciphertext store {} doesn't match the CryptoContext, it has ring "
+        "dimension {} with {} moduli",
+        filename, ringDim, numModuli));
+  }
+  for (uint32_t t = 0; t < numModuli; ++t) {
+    if (readRaw<uint64_t>(ptr) !=
+        towers[t]->GetModulus().ConvertToInt<uint64_t>()) {
+      throw std::runtime_error(fmt::format(
+          "Ciphertext store {} doesn't match the CryptoContext, modulus {} "
+          "differs",
+          filename, t));
+    }
+  }
+
+  params.resize(numModuli);
+  params[numModuli - 1] = full;
+  for (int k = (int)numModuli - 2; k >= 0; --k) {
+    params[k] = std::make_shared<DCRTPoly::Params>(*params[k + 1]);
+    params[k]->PopLastParam();
+  }
+
+  if (indexPosition > file.size() ||
+      (file.size() - indexPosition) / sizeof(StoreEntry) < count) {
+    throw std::runtime_error("Ciphertext store is truncated: " + filename);
+  }
+  entries.resize(count);
+  std::memcpy(entries.data(), file.data() + indexPosition,
+              count * sizeof(StoreEntry));
+
+  uint64_t stride = limbStride(ringDim);
+  for (uint64_t i = 0; i < count; ++i) {
+    auto &entry = entries[i];
+    uint64_t limbs = (uint64_t)entry.numElements * entry.numTowers;
+    if (entry.numTowers == 0 || entry.numTowers > numModuli ||
+        entry.offset > indexPosition ||
+        limbs > (indexPosition - entry.offset) / stride ||
+        entry.tagOffset > indexPosition ||
+        entry.tagLength > indexPosition - entry.tagOffset) {
+      throw std::runtime_error(fmt::format(
+          "Ciphertext store {} has a corrupt index entry for ciphertext {}",
+          filename, i));
+    }
+  }
+}
+
+Ciphertext<DCRTPoly>
+pyOpenFHE::MappedCiphertextStore::materialize(size_t i) const {
+  const StoreEntry &entry = entries.at(i);
+  auto &elementParams = params[entry.numTowers - 1];
+  auto &towers = elementParams->GetParams();
+  uint64_t stride = limbStride(ringDim);
+  const char *base = file.data() + entry.offset;
+
+  std::vector<DCRTPoly> elements(
+      entry.numElements, DCRTPoly(elementParams, Format::EVALUATION, true));
+  int num_limbs = entry.numElements * entry.numTowers;
+
+#pragma omp parallel for
+  for (int l = 0; l < num_limbs; ++l) {
+    uint32_t e = l / entry.numTowers;
+    uint32_t t = l % entry.numTowers;
+    const char *limb = base + l * stride;
+
+    NativeVector values(ringDim, towers[t]->GetModulus());
+    for (uint32_t j = 0; j < ringDim; ++j) {
+      uint64_t word;
+      std::memcpy(&word, limb + j * sizeof(uint64_t), sizeof(word));
+      values[j] = word;
+    }
+    elements[e].GetAllElements()[t].SetValues(std::move(values),
+                                              Format::EVALUATION);
+  }
+
+  auto ctxt = std::make_shared<CiphertextImpl<DCRTPoly>>(cc);
+  ctxt->SetElements(std::move(elements));
+  ctxt->SetLevel(entry.level);
+  ctxt->SetNoiseScaleDeg(entry.noiseScaleDeg);
+  ctxt->SetSlots(entry.slots);
+  ctxt->SetEncodingType((PlaintextEncodings)entry.encodingType);
+  ctxt->SetScalingFactor(entry.scalingFactor);
+  ctxt->SetScalingFactorInt(NativeInteger(entry.scalingFactorInt));
+  ctxt->SetKeyTag(
+      std::string(file.data() + entry.tagOffset, entry.tagLength));
+  return ctxt;
+}
+
+Ciphertext<DCRTPoly> pyOpenFHE::MappedCiphertextStore::get(size_t i) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(i);
+    if (it != cache.end()) {
+      order.splice(order.begin(), order, it->second.second);
+      return it->second.first;
+    }
+  }
+
+  // two threads may both materialize i, the second one just loses
+  auto ctxt = materialize(i);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (cacheSize == 0) {
+    return ctxt;
+  }
+  auto it = cache.find(i);
+  if (it != cache.end()) {
+    order.splice(order.begin(), order, it->second.second);
+    return it->second.first;
+  }
+  order.push_front(i);
+  cache.emplace(i, std::make_pair(ctxt, order.begin()));
+  while (cache.size() > cacheSize) {
+    cache.erase(order.back());
+    order.pop_back();
+  }
+  return ctxt;
+}
+
+bool pyOpenFHE::MappedCiphertextStore::resident(size_t i) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return cache.count(i) > 0;
+}
+
+size_t pyOpenFHE::MappedCiphertextStore::residentCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return cache.size();
+}
+
+void pyOpenFHE::MappedCiphertextStore::clearCache() {
+  std::lock_guard<std::mutex> lock(mutex);
+  cache.clear();
+  order.clear();
+}
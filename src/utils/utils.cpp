@@ -79,6 +79,33 @@ std::vector<int> pyOpenFHE::pythonListToCppIntVector(const list &pylist) {
   return cppVector;
 }
 
+std::vector<uint32_t>
+pyOpenFHE::pythonListToBootstrapPair(const object &pylist,
+                                     const std::string &name, int minimum) {
+  if (len(pylist) != 2) {
+    throw std::runtime_error(fmt::format(
+        "{} must have 2 entries (CoeffsToSlots, SlotsToCoeffs), got {}", name,
+        len(pylist)));
+  }
+  std::vector<uint32_t> cppVector;
+  for (int i = 0; i < 2; i++) {
+    int value = extract<int>(pylist[i]);
+    if (value < minimum) {
+      throw std::runtime_error(fmt::format(
+          "{} entries must be at least {}, got {}", name, minimum, value));
+    }
+    cppVector.push_back(value);
+  }
+  return cppVector;
+}
+
+pyOpenFHE::ScopedBuffer::ScopedBuffer(const object &obj, bool writable) {
+  int flags = writable ? PyBUF_WRITABLE : PyBUF_SIMPLE;
+  if (PyObject_GetBuffer(obj.ptr(), &view, flags) != 0) {
+    throw_error_already_set();
+  }
+}
+
 std::vector<int> pyOpenFHE::numpyListToCppIntVector(const ndarray &nplist) {
   std::vector<int> cppVector;
   for (unsigned int i = 0; i < nplist.shape(0); i++) {
@@ -314,6 +341,17 @@ void tileVector(std::vector<int> &vals, unsigned int final_size) {
   }
 }
 
+// cyclic left rotation, matching ciphertext << r on the packed slots
+// i.e. rotateVector([1, 2, 3, 4], 1) gives [2, 3, 4, 1]
+std::vector<double> rotateVector(const std::vector<double> &vals, int r) {
+  int n = vals.size();
+  std::vector<double> rotated(n);
+  for (int i = 0; i < n; i++) {
+    rotated[i] = vals[(((i + r) % n) + n) % n];
+  }
+  return rotated;
+}
+
 template <typename T> void print_vector(std::vector<T> vec) {
   for (int i = 0; i < (int)vec.size(); i++) {
     std::cout << vec[i] << " ";